@@ -0,0 +1,22 @@
+#pragma once
+#include "game.h"
+#include "rng.h"
+
+// Simple greedy player for headless simulation: heads for the nearest
+// regular food, never steps into an occupied cell if another move is free,
+// stays out of dead ends (Game::GetRegionAhead) when it can, and otherwise
+// picks at random. Deterministic for a given seed.
+class Bot {
+public:
+    explicit Bot(uint64_t seed = 1);
+
+    // chance (0..1) of making a random move instead of the greedy one
+    void SetMistakeRate(float rate);
+
+    // next direction for the game's current state
+    Dir Choose(const Game& game);
+
+private:
+    Rng m_rng;
+    float m_mistakeRate;
+};
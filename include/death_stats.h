@@ -0,0 +1,67 @@
+#pragma once
+#include "game.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Fixed-size histograms of how simulated games ended: death cells per level,
+// causes, lengths and lifetimes. Memory depends on the board size only, not
+// on the number of games, so one instance per thread can absorb any number
+// of games and the instances are then merged.
+class DeathStats {
+public:
+    // levels past this share the last bucket
+    static const int MAX_LEVELS = 16;
+    // survival curve resolution: ticks per bucket and bucket count;
+    // longer games land in one extra overflow bucket
+    static const int TICK_BUCKET = 10;
+    static const int TICK_BUCKETS = 1000;
+
+    DeathStats(int cols, int rows);
+
+    // a game that just ended (IsGameOver) after `ticks` ticks
+    void AddDeath(const Game& game, uint64_t ticks);
+    // a game stopped at the tick limit while still alive
+    void AddSurvivor(const Game& game, uint64_t ticks);
+
+    // fold another instance (same board size) into this one
+    void Merge(const DeathStats& other);
+
+    uint64_t Games() const;
+    uint64_t Deaths() const;
+    uint64_t Deaths(DeathCause cause) const;
+    // deepest level bucket any game reached
+    int MaxLevel() const;
+
+    // Heatmaps are written row by row, one row buffer at a time.
+    // PGM: log-scaled death counts over all levels.
+    bool WriteHeatmap(const std::string& path, std::string& error) const;
+    // PPM for one level: deaths from red to yellow over the level's
+    // obstacles in blue
+    bool WriteLevelHeatmap(const std::string& path, int level, std::string& error) const;
+
+    // tick, alive fraction, deaths by cause per tick bucket
+    bool WriteSurvivalCsv(const std::string& path, std::string& error) const;
+    // per level: deaths by cause, mean length and mean ticks at death
+    bool WriteLevelCsv(const std::string& path, std::string& error) const;
+
+private:
+    struct LevelTotals {
+        uint64_t deaths[2];  // SELF, OBSTACLE
+        uint64_t survivors;
+        uint64_t lengthSum;
+        uint64_t tickSum;
+    };
+
+    static int LevelBucket(int level);
+    static int TickBucket(uint64_t ticks);
+    void RememberLayout(const Game& game, int bucket);
+
+    int m_cols, m_rows;
+    std::vector<uint32_t> m_cells;    // deaths per [level bucket][cell]
+    std::vector<uint8_t> m_layouts;   // obstacle per [level bucket][cell]
+    std::vector<uint8_t> m_hasLayout; // per level bucket
+    std::vector<LevelTotals> m_levels;
+    std::vector<uint64_t> m_ticks;    // deaths per [tick bucket][cause]
+    uint64_t m_survivors;
+};
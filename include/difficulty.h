@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Tunable difficulty rules used for every level a level pack doesn't define.
+// Defaults are the original hand-picked values; tools/tune searches for
+// better ones and writes them in the text format read by Load.
+struct DifficultyConfig {
+    int pointsPerLevel;    // score needed for each further level
+    float baseTick;        // seconds per step at level 1
+    float tickStep;        // seconds taken off per level
+    float minTick;         // fastest step
+    int foodValue;         // regular food
+    int bonusFoodValue;    // second, more valuable food
+    int poisonValue;       // negative; every -10 shrinks the snake by one
+    int levelBonusFood;    // value of the food added every bonusEvery levels
+    int bonusEvery;
+
+    DifficultyConfig();
+
+    float TickSeconds(int level) const;
+    // FNV-1a over every field; equal hashes mean the same rules
+    uint64_t Hash() const;
+
+    // key value lines, '#' comments; keys left out keep their defaults
+    bool Load(const std::string& path, std::string& error);
+    bool Save(const std::string& path, std::string& error) const;
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include "pos.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Things that happen inside Game, in the order they happen.
+// Meaning of a / b / pos per type:
+enum class GameEventType : uint8_t {
+    GAME_STARTED,    // a = 1 if a saved session was resumed
+    FOOD_SPAWNED,    // a = food index, pos = cell
+    FOOD_HIDDEN,     // a = food index, pos = cell it left (poison waiting to respawn)
+    FOOD_EATEN,      // a = value, b = food index, pos = cell
+    POISON_EATEN,    // a = segments lost, b = food index, pos = cell
+    SCORE_CHANGED,   // a = score, b = points gained
+    LEVEL_CHANGED,   // a = new level, b = previous level
+    NEW_HIGH_SCORE,  // a = score, b = previous high score
+    GAME_OVER        // a = DeathCause, b = final score, pos = death cell
+};
+
+struct GameEvent {
+    GameEventType type;
+    int32_t a, b;
+    Pos pos;
+    uint64_t tick;   // Game::GetTick() when it happened
+};
+
+// Fixed-capacity broadcast ring buffer: one producer (the Game's thread)
+// and any number of EventReaders, each with its own cursor, on any thread.
+// Publishing never blocks, never allocates and never waits for readers. A
+// reader that falls more than CAPACITY events behind skips the overwritten
+// ones and counts them as dropped.
+//
+// Slots are seqlocks over atomic words, so a reader racing the producer
+// sees either the whole event or a sequence mismatch, never a torn event.
+class EventStream {
+public:
+    static const size_t CAPACITY = 1024;  // power of two
+
+    EventStream();
+
+    EventStream(const EventStream&) = delete;
+    EventStream& operator=(const EventStream&) = delete;
+
+    // producer thread only
+    void Publish(const GameEvent& event);
+
+    // sequence number the next event will get (= events published so far)
+    uint64_t Head() const;
+
+private:
+    friend class EventReader;
+
+    static const size_t WORDS = (sizeof(GameEvent) + 7) / 8;
+
+    struct Slot {
+        // 2*seq+1 while event seq is being written, 2*seq+2 once published
+        std::atomic<uint64_t> version;
+        std::atomic<uint64_t> words[WORDS];
+    };
+
+    // copy event seq out of its slot; false if it was overwritten
+    bool Read(uint64_t seq, GameEvent& out) const;
+
+    Slot m_slots[CAPACITY];
+    std::atomic<uint64_t> m_head;
+};
+
+// One consumer's position in an EventStream. Not shared between threads;
+// give every consumer (renderer, audio, analytics, replay...) its own.
+class EventReader {
+public:
+    // starts at the stream's current head (only sees new events)
+    explicit EventReader(const EventStream& stream);
+
+    // next unread event; false when caught up
+    bool Next(GameEvent& out);
+
+    // events skipped because this reader fell too far behind
+    uint64_t Dropped() const;
+
+private:
+    const EventStream* m_stream;
+    uint64_t m_next;
+    uint64_t m_dropped;
+};
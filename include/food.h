@@ -1,22 +1,33 @@
 #pragma once
 #include "pos.h"
-#include <vector>
-#include <cstdlib>
+#include "world.h"
+#include "rng.h"
+#include "reachability.h"
 
 class Food {
 public:
     // value = score gained when eaten (negative for poison)
-    // isPoison = spawns less frequently (1 in 5 respawns)
+    // isPoison = shrinks the snake; Game shows it on a timer (see TimerEvent)
     Food(int cols, int rows, int value = 10, bool isPoison = false);
 
     Pos GetPosition() const;
     int GetValue() const;
+    void SetValue(int value);
     bool IsPoison() const;
     bool IsVisible() const;
 
-    // Respawn avoids positions occupied by snake and otherFoodsPositions
-    void Respawn(const std::vector<Pos>& snake,
-                 const std::vector<Pos>& otherFoodsPositions = {});
+    // Respawn picks a random free cell (no CellFlag set) inside the
+    // areaCols x areaRows window starting at areaMin, wrapping around the board.
+    // With reach, only cells reachable from `from` qualify while there are any.
+    // A respawned food is always visible.
+    void Respawn(World& world, Rng& rng, Pos areaMin, int areaCols, int areaRows,
+                 const Reachability* reach = nullptr, Pos from = {0, 0});
+
+    // take the food off the board until the next Respawn
+    void Hide();
+
+    // put back a saved position and visibility (session restore)
+    void Restore(Pos pos, bool visible);
 
 private:
     int m_cols, m_rows;
@@ -24,5 +35,4 @@ private:
     int m_value;
     bool m_isPoison;
     bool m_visible;
-    int m_respawnCounter; // For poison food spawn delay
 };
\ No newline at end of file
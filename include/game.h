@@ -2,10 +2,30 @@
 #include "pos.h"
 #include <vector>
 #include "food.h"
+#include "timer_wheel.h"
+#include "world.h"
+#include "reachability.h"
+#include "level_pack.h"
+#include "difficulty.h"
+#include "event_stream.h"
 #include <string>
+#include <cstdint>
+#include <memory>
 
 enum class Dir { UP, DOWN, LEFT, RIGHT };
 
+// events scheduled on Game's timer wheel (arg = food index)
+enum class TimerEvent {
+    SPAWN_FOOD  // put a hidden food back on the board
+};
+
+// what ended the game
+enum class DeathCause {
+    NONE,       // still alive
+    SELF,       // ran into its own body
+    OBSTACLE    // ran into an obstacle
+};
+
 enum class GameState {
     MENU,       // Main menu with Start/Exit
     PLAYING,    // Active gameplay
@@ -13,6 +33,9 @@ enum class GameState {
     GAME_OVER   // Game over screen
 };
 
+// generated layouts of one board size (game.cpp)
+struct GeneratedLevelSet;
+
 class Game {
 public:
     Game(int cols = 20, int rows = 20, int initialFoodCount = 2);
@@ -24,12 +47,23 @@ public:
     void Grow();
 
     bool IsGameOver() const;
+    DeathCause GetDeathCause() const;
+    // the cell the head tried to enter when the game ended
+    Pos GetDeathCell() const;
     bool IsPaused() const;
     void TogglePause();
     int GetScore() const;
     int GetLevel() const;
+    // seconds per step at the current level
+    float GetSpeed() const;
     int GetHighScore() const;
 
+    int GetCols() const;
+    int GetRows() const;
+
+    // simulation ticks since the game was created
+    uint64_t GetTick() const;
+
     const std::vector<Pos>& GetSnake() const;
 
     // returns vector of current food objects
@@ -38,9 +72,97 @@ public:
     // returns vector of obstacle positions
     const std::vector<Pos>& GetObstacles() const;
 
+    // CellFlag bits at p; unlike GetObstacles() this also sees procedural
+    // obstacles (may load a world chunk)
+    unsigned char GetCellFlags(Pos p);
+    // never loads chunks; unexplored procedural cells read as empty
+    unsigned char PeekCellFlags(Pos p) const;
+    const World& GetWorld() const;
+
+    // Free cells in the region the head enters when moving in direction d
+    // (its connected area of cells without snake or obstacle): a region
+    // smaller than the snake is a dead end. 0 if that cell is blocked, -1
+    // on boards too large to track (procedural worlds, over a million
+    // cells). Food only spawns in regions the head can reach.
+    int GetRegionAhead(Dir d) const;
+
+    // Replace the hand-coded levels with an endless procedurally generated
+    // obstacle field (generated per chunk from seed) and restart.
+    // Use with large boards; GetObstacles() is empty in this mode.
+    void EnableProceduralWorld(uint64_t seed);
+
+    // Generated levels past the current one are built in the background
+    // while it is played. Runs faster than real time (tests, tools) can
+    // outrun that; this builds whatever is left now, on this thread.
+    void FinishGeneratedLevels();
+
+    // 64-bit Zobrist hash of snake, direction, foods and obstacles.
+    // Maintained incrementally; equal states give equal hashes on every client.
+    uint64_t GetStateHash() const;
+
+    // recompute the hash from scratch (slow, for verification)
+    uint64_t ComputeStateHash() const;
+
     void Restart();
 
+    // Seed the random stream used for food placement. Seeding and then
+    // calling StartGame() replays the same game for the same inputs.
+    void SetSeed(uint64_t seed);
+    // seed that replays the current run: SetSeed(GetStartSeed()); StartGame()
+    uint64_t GetStartSeed() const;
+
+    // where the high score is kept; "" disables loading and saving
+    // (headless and parallel runs)
+    void SetHighScoreFile(const std::string& path);
+
+    // Use a compiled level pack (see levels/) for thresholds, speeds, bonus
+    // foods, poison delays and layouts of the levels it defines; built-in
+    // rules cover the rest. Reloading during a game applies immediately.
+    bool LoadLevelPack(const std::string& path, std::string* error = nullptr);
+    // checksum of the loaded pack's file, 0 without a pack
+    uint64_t GetLevelPackChecksum() const;
+
+    // level thresholds, speed curve and food values for levels the level
+    // pack doesn't define (see tools/tune); applies immediately
+    void SetDifficulty(const DifficultyConfig& difficulty);
+    const DifficultyConfig& GetDifficulty() const;
+
     void SetDirection(Dir d);
+    Dir GetDirection() const;
+
+    // Publish GameEvents (food eaten, score, level, game over...) to stream
+    // as they happen; nullptr turns events off. The stream is not owned and
+    // must outlive the game or be detached first.
+    void SetEventStream(EventStream* stream);
+    EventStream* GetEventStream() const;
+
+    // Speculative ticks (see Speculator): copy or exchange everything the
+    // simulation owns with another game of the same board. The event stream
+    // and the high score file stay with their Game objects. Copies reuse
+    // this game's allocations; SwapState is O(1), and saves a high score the
+    // adopted state beat to this game's file.
+    void CopyStateFrom(const Game& other);
+    void SwapState(Game& other);
+
+    // Speculative ticks, without copying: SetDirection(d) (reversals
+    // included) and Update(), noting what UndoUpdate needs to put the game
+    // back as it was. The events the tick published stay published. A tick
+    // that changed the level or more of the board than the journals hold
+    // can't be undone: UndoUpdate is false and leaves the game as it is.
+    void UpdateUndoable(Dir d);
+    bool UndoUpdate();
+
+    // Compact binary snapshot of a game in progress: snake, foods, pending
+    // timers (poison respawn), score, level, RNG and the direction queued
+    // for the next tick. Obstacles are named by where the level's layout
+    // comes from, not listed. SessionStore adds the version tag and
+    // checksum. LoadSnapshot checks everything before touching the game and
+    // resumes it paused.
+    void SaveSnapshot(std::vector<unsigned char>& out) const;
+    bool LoadSnapshot(const unsigned char* data, size_t size, std::string* error = nullptr);
+    // start building the generated layout LoadSnapshot of this snapshot will
+    // need in the background (at launch, so that Continue only copies it in)
+    void PrefetchSnapshot(const unsigned char* data, size_t size);
 
     // Game state management
     GameState GetState() const;
@@ -49,6 +171,18 @@ public:
 
 private:
     void MoveHead();
+    // load the procedural chunks the board view can show around the head
+    void LoadChunksAroundHead();
+    void PopTail();
+    void ResetSnake();
+    void RespawnFood(size_t i);
+    void HideFood(size_t i);
+    void OnTimer(TimerEvent event, int arg);
+    void Emit(GameEventType type, int a = 0, int b = 0, Pos pos = {0, 0});
+    void PlaceFood(Food& food);
+    uint64_t FoodKey(size_t i) const;
+    // aborts if the incremental hash diverged (SNAKE_VERIFY_HASH builds only)
+    void VerifyStateHash() const;
     bool CheckSelfCollision(const Pos& newHead);
     bool CheckObstacleCollision(const Pos& pos);
     void LoadHighScore();
@@ -56,25 +190,106 @@ private:
 
     // recompute level & speed from score
     void RecalculateLevelAndSpeed();
+    int LevelForScore(int score) const;
+    float TickSecondsForLevel(int level) const;
+    int BonusFoodForLevel(int level) const;
+    uint64_t PoisonDelay() const;
+
+    // regenerate the current level's obstacles and move foods off them
+    void RefreshObstacles();
+
+    // rebuild m_reach after bulk World changes
+    void SyncReachability();
+
+    // where a level's obstacles come from; snapshots store this
+    enum class LayoutSource : uint8_t { PROCEDURAL, LEVEL_PACK, HAND_CODED, GENERATED };
+    struct LayoutId {
+        LayoutSource source;
+        int32_t index;   // level in the pack / hand-coded / generated table
+        uint64_t seed;   // pack checksum or generator seed, 0 otherwise
+    };
+    LayoutId LayoutForLevel(int level) const;
 
     // generate obstacles based on current level
     void GenerateObstaclesForLevel(int level);
 
+    // fetch this board size's generated level set (before the first tick)
+    void PrepareGeneratedLevels();
+    // queue background builds of the generated levels, `first` first
+    void BuildGeneratedLevelsFrom(int first);
+    // reserve m_obstacles for the largest layout a level change can load
+    void ReserveObstacles();
+
 private:
     int m_cols, m_rows;
     std::vector<Pos> m_snake;
     Dir m_dir;
     bool m_grow;
     bool m_gameOver;
+    DeathCause m_deathCause;
+    Pos m_deathCell;
     bool m_paused;
     int m_score;
     int m_level;
     float m_speed; // seconds per step
     std::vector<Food> m_foods;
     std::vector<Pos> m_obstacles;
+    uint64_t m_hash;
+
+    // chunked CellFlag grid mirroring snake, obstacles and foods,
+    // so collision and respawn checks are O(1)
+    World m_world;
+
+    // connected regions of free cells, updated as the snake moves
+    Reachability m_reach;
+
+    // timed events (poison spawn delay, ...), advanced once per Update
+    TimerWheel m_timers;
+
+    // procedurally generated layouts, indexed by level; shared by all games
+    // of this board size and built in the background ahead of need
+    std::shared_ptr<GeneratedLevelSet> m_generatedLevels;
+
+    LevelPack m_levelPack;
+    DifficultyConfig m_difficulty;
+
+    // food placement; seeded from the clock unless SetSeed is called
+    Rng m_rng;
+    uint64_t m_startSeed;  // m_rng state when the run started
 
     int m_highScore;
     std::string m_highScoreFile;
 
     GameState m_state;  // Current game state
+
+    EventStream* m_events;  // not owned, may be null
+
+    // what UpdateUndoable saved besides the World and Reachability journals
+    struct Undo {
+        static const int TAILS = 8;  // tail cells kept for the tick to pop
+
+        bool valid;
+        bool headAdded;
+        Dir dir;
+        bool grow;
+        bool gameOver;
+        DeathCause deathCause;
+        Pos deathCell;
+        int score;
+        int level;
+        float speed;
+        uint64_t hash;
+        int highScore;
+        GameState state;
+        std::vector<Food> foods;
+        Rng rng;
+        TimerWheel timers;
+        size_t snakeSize;
+        int tailCount;
+        Pos tails[TAILS];  // the last tailCount cells of the snake
+
+        // sized by the first UpdateUndoable
+        Undo() : valid(false), timers(0) {}
+    };
+    Undo m_undo;
 };
\ No newline at end of file
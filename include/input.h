@@ -7,6 +7,10 @@ public:
     // Process input based on current game state
     static void Process(Game& game);
     
+    // Camera zoom steps requested this frame (mouse wheel, +/- keys);
+    // positive zooms in
+    static float GetZoomDelta();
+
     // Check if mouse is over a rectangle (for button hover)
     static bool IsMouseOverRect(int x, int y, int width, int height);
 };
\ No newline at end of file
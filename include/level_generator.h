@@ -0,0 +1,24 @@
+#pragma once
+#include "pos.h"
+#include <cstdint>
+#include <vector>
+
+// Seeded procedural obstacle layouts for any board size and level.
+// A fixed number of candidates is generated in parallel (ThreadPool::Shared)
+// and each is repaired so that every free cell is reachable from the spawn
+// area: pockets the flood fill can't reach are filled in. The candidate whose
+// difficulty is closest to the level's target wins.
+// The result depends only on the arguments, never on the thread count.
+class LevelGenerator {
+public:
+    // cells in [clearMin, clearMax] stay free (the Restart spawn area)
+    static std::vector<Pos> Generate(int cols, int rows, int level, uint64_t seed,
+                                     Pos clearMin, Pos clearMax);
+
+    // difficulty the generator aims for at this level (0..1)
+    static float TargetDifficulty(int level);
+
+    // obstacle density plus penalties for narrow cells and dead ends,
+    // on a cols*rows row-major map (nonzero = obstacle)
+    static float MeasureDifficulty(const std::vector<unsigned char>& blocked, int cols, int rows);
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Binary level pack, compiled from a text source by the levelpack tool
+// (see levels/default.txt) and memory-mapped at runtime. The file is laid
+// out so it can be used in place:
+//
+//   LevelPackHeader
+//   LevelPackEntry[levelCount]
+//   obstacle bitmaps, one bit per cell, row-major, (cols*rows+7)/8 bytes each
+//
+// All fields are little-endian.
+const char LEVEL_PACK_MAGIC[8] = { 'S', 'N', 'K', 'P', 'A', 'C', 'K', 0 };
+const uint32_t LEVEL_PACK_VERSION = 1;
+
+struct LevelPackHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t levelCount;
+    uint32_t cols, rows;
+    uint32_t fileSize;
+    uint32_t reserved;
+};
+
+struct LevelPackEntry {
+    uint32_t scoreThreshold;  // score needed to reach this level
+    float tickSeconds;        // seconds per snake step
+    int32_t bonusFoodValue;   // extra food added on reaching the level, 0 = none
+    uint32_t poisonDelay;     // ticks poison stays hidden after being eaten
+    uint32_t bitmapOffset;    // from the start of the file
+    uint32_t obstacleCount;
+};
+
+static_assert(sizeof(LevelPackHeader) == 32, "level pack header layout");
+static_assert(sizeof(LevelPackEntry) == 24, "level pack entry layout");
+
+class LevelPack {
+public:
+    LevelPack();
+
+    // map a compiled pack; on failure the previous pack (if any) is kept
+    bool Load(const std::string& path, std::string* error = nullptr);
+    void Unload();
+    bool IsLoaded() const;
+
+    int LevelCount() const;
+    int Cols() const;
+    int Rows() const;
+    // FNV-1a of the whole file, taken once at load; 0 when nothing is loaded
+    uint64_t Checksum() const;
+
+    // level is 1-based; nullptr past the last level
+    const LevelPackEntry* Level(int level) const;
+    bool IsObstacle(const LevelPackEntry& entry, int x, int y) const;
+
+    // compile a text source into a binary pack (used by the levelpack tool)
+    static bool Compile(const std::string& sourcePath, const std::string& packPath,
+                        std::string& error);
+
+private:
+    struct MappedFile;
+    // shared so copies of a Game keep using the same mapping
+    std::shared_ptr<const MappedFile> m_file;
+    const LevelPackHeader* m_header;
+    const LevelPackEntry* m_entries;
+    uint64_t m_checksum;
+};
+
+// Watches a pack file for replacement (development builds hot-reload with it).
+// Uses inotify on Linux; elsewhere Changed() never fires.
+class LevelPackWatcher {
+public:
+    explicit LevelPackWatcher(const std::string& path);
+    ~LevelPackWatcher();
+
+    LevelPackWatcher(const LevelPackWatcher&) = delete;
+    LevelPackWatcher& operator=(const LevelPackWatcher&) = delete;
+
+    // non-blocking; true once after the file was rewritten or replaced
+    bool Changed();
+
+private:
+    std::string m_dir;
+    std::string m_name;
+    int m_fd;
+};
@@ -0,0 +1,115 @@
+#pragma once
+#include "pos.h"
+#include "world.h"
+#include <cstdint>
+#include <vector>
+
+// Connected regions of free cells (no snake, no obstacle; food is free) on a
+// wrapping board, kept up to date as the snake moves instead of flood
+// filling every tick.
+//
+// Freeing a cell (tail retracts) is a union-find union. Occupying one (head
+// advances) first checks the ring of 8 cells around it: if the free
+// neighbours stay connected through the ring, nothing can split. Otherwise
+// a search runs from each side in lock step; a side that runs out of cells
+// is a region that got cut off and is relabeled, which costs the size of
+// that small region only. If the searches don't settle within a budget, the
+// structure is marked dirty and rebuilt from the World by the owner.
+//
+// Only bounded boards are tracked (up to MAX_CELLS cells); on larger boards
+// and in procedural worlds IsEnabled() is false and queries answer -1.
+// Const queries don't modify anything and may run concurrently.
+class Reachability {
+public:
+    static const int64_t MAX_CELLS = 1 << 20;
+
+    Reachability(int cols, int rows);
+
+    // Copies share no scratch: the split search buffers stay with each
+    // object, and the node pool keeps its reserve, so assigning between
+    // objects of the same size doesn't allocate.
+    Reachability(const Reachability& other);
+    Reachability& operator=(const Reachability& other);
+    Reachability(Reachability&&) = default;
+    Reachability& operator=(Reachability&&) = default;
+
+    bool IsEnabled() const { return m_enabled; }
+    // stop tracking and release the memory (procedural worlds)
+    void Disable();
+
+    // the World changed in bulk (restart, new obstacles): Rebuild before
+    // the next query
+    void MarkDirty() { m_dirty = true; }
+    bool IsDirty() const { return m_enabled && m_dirty; }
+    // recompute everything from the World's snake and obstacle flags
+    void Rebuild(const World& world);
+
+    // Undo for speculative ticks, like World's: between StartJournal and
+    // StopJournal every entry Occupy and Free change is noted, and RollBack
+    // restores them. StopJournal is false after a Rebuild or too many
+    // changes. Copies don't take the journal.
+    void StartJournal();
+    bool StopJournal();
+    void RollBack();
+
+    // a cell became blocked / free (call after updating the World)
+    void Occupy(Pos p);
+    void Free(Pos p);
+
+    // cells in p's region; 0 if p is blocked, -1 when not tracked
+    int RegionSize(Pos p) const;
+    // true if free cell p can be reached from `from` (typically the head,
+    // itself blocked) through free cells; always true when not tracked
+    bool Reachable(Pos from, Pos p) const;
+
+    // full rebuilds so far (for profiling)
+    uint64_t Rebuilds() const { return m_rebuilds; }
+
+private:
+    int Index(Pos p) const { return p.y * m_cols + p.x; }
+    Pos Neighbor(Pos p, int dir) const;
+    // cell indices of Neighbor(p, 0..7)
+    void RingCells(Pos p, int out[8]) const;
+    int Root(int node) const;
+    int FindAndCompress(int node);
+    int NewNode(int size);
+    void Union(int a, int b);
+    // p was just blocked: find out whether its region split
+    void CheckSplit(Pos p);
+    // every m_cellNode / m_parent / m_size write goes through here
+    void Set(int32_t& slot, int32_t value) {
+        if (m_journaling) Note(slot);
+        slot = value;
+    }
+    void Note(int32_t& slot);
+
+    int m_cols, m_rows;
+    bool m_enabled;
+    bool m_dirty;
+    uint64_t m_rebuilds;
+    int m_ringOffset[8];  // index offsets of the ring cells off the edges
+
+    std::vector<int32_t> m_cellNode;  // union-find node per cell, -1 if blocked
+    // Node pool: a freed cell joins a neighbour's root or gets a fresh node,
+    // occupied cells leave theirs behind inside the tree. Rebuild compacts
+    // it once it fills up.
+    std::vector<int32_t> m_parent;
+    std::vector<int32_t> m_size;      // free cells under a root
+
+    std::vector<unsigned char> m_row;  // World row read by Rebuild
+
+    // split search scratch, reserved up front
+    std::vector<uint32_t> m_mark;     // epoch << 2 | search, per cell
+    uint32_t m_epoch;
+    std::vector<int32_t> m_queue[4];
+
+    struct JournalEntry {
+        int32_t* slot;   // the pool is reserved, so entries never move
+        int32_t value;   // before the change
+    };
+    std::vector<JournalEntry> m_journal;  // reserved by the first StartJournal
+    size_t m_journalNodes;  // node pool size at StartJournal
+    bool m_journalDirty;    // m_dirty at StartJournal
+    bool m_journaling;
+    bool m_journalFull;
+};
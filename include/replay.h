@@ -0,0 +1,56 @@
+#pragma once
+#include "game.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A recorded run: board, seeds and the direction in effect on every tick.
+// Game is deterministic for a given seed, so this is enough to play the run
+// back exactly, given the same level pack and difficulty config; the file
+// names both by checksum so a player can refuse other rules.
+//
+// File: "SNKRPLY\0", uint32 version, int32 cols, rows, uint8 procedural,
+// uint64 world seed, uint64 start seed, uint64 level pack checksum,
+// uint64 difficulty hash, int32 high score, uint32 ticks, then one Dir byte
+// per tick.
+class Replay {
+public:
+    static const uint32_t VERSION = 2;
+
+    Replay();
+
+    // start recording the run `game` just started
+    void Begin(const Game& game);
+    // direction used by the next Update (capacity is reserved, so this
+    // only allocates for very long runs)
+    void RecordTick(Dir d);
+
+    bool Save(const std::string& path, std::string& error) const;
+    bool Load(const std::string& path, std::string& error);
+
+    int Cols() const { return m_cols; }
+    int Rows() const { return m_rows; }
+    // high score shown when the run was played
+    int HighScore() const { return m_highScore; }
+    size_t Ticks() const { return m_dirs.size(); }
+    Dir TickDirection(size_t tick) const { return (Dir)m_dirs[tick]; }
+
+    // false (with the reason) unless `game` plays with the level pack and
+    // difficulty the run was recorded with
+    bool CheckRules(const Game& game, std::string& error) const;
+
+    // restart `game` (a cols x rows board) as the recorded run
+    void Start(Game& game) const;
+    // play recorded tick `tick` (call for 0, 1, 2... after Start)
+    void Step(Game& game, size_t tick) const;
+
+private:
+    int m_cols, m_rows;
+    bool m_procedural;
+    uint64_t m_worldSeed;
+    uint64_t m_startSeed;
+    uint64_t m_packChecksum;
+    uint64_t m_difficultyHash;
+    int m_highScore;
+    std::vector<uint8_t> m_dirs;
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+
+// Small, fast seeded generator (splitmix64). Plain data: copying a Game
+// copies its random stream, and the same seed replays the same game.
+class Rng {
+public:
+    explicit Rng(uint64_t seed = 0) : m_state(seed) {}
+
+    void Seed(uint64_t seed) { m_state = seed; }
+    uint64_t GetState() const { return m_state; }
+
+    uint64_t Next() {
+        uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // uniform in [0, n)
+    int Below(int n) {
+        return (int)(((Next() >> 32) * (uint64_t)(uint32_t)n) >> 32);
+    }
+
+    // uniform in [0, 1)
+    float Uniform() {
+        return (float)(Next() >> 40) * (1.0f / 16777216.0f);
+    }
+
+private:
+    uint64_t m_state;
+};
@@ -0,0 +1,73 @@
+#pragma once
+#include "game.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Session checkpoint file: a small header (magic, format version, payload
+// size, FNV-1a checksum) followed by a Game snapshot. Files from another
+// version, truncated or corrupted files are rejected.
+struct SessionHeader {
+    char magic[8];          // "SNKSAVE\0"
+    uint32_t version;
+    uint32_t payloadSize;
+    uint64_t checksum;      // FNV-1a 64 of the payload
+};
+static_assert(sizeof(SessionHeader) == 24, "SessionHeader layout is part of the file format");
+
+// Saves the running game in the background and restores it on launch.
+// SaveAsync takes the snapshot on the calling thread (a few microseconds)
+// and a writer thread puts it on disk via a temporary file and a rename, so
+// a crash mid-write never leaves a half-written session behind.
+class SessionStore {
+public:
+    // 2: snapshots carry the tick and the run's start seed
+    // 3: obstacles are named by their layout instead of listed
+    static const uint32_t VERSION = 3;
+
+    explicit SessionStore(const std::string& path);
+    // finishes a pending write
+    ~SessionStore();
+
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+
+    void SaveAsync(const Game& game);
+    // wait until pending writes are on disk
+    void Flush();
+
+    // true if a session file passed the version and checksum checks (checked
+    // at construction, updated by saves and Remove)
+    bool HasSession() const;
+
+    // restore the saved game (paused); false if missing, invalid, or for
+    // another board
+    bool Load(Game& game, std::string* error = nullptr);
+    // at launch: start building in the background what Load into `game`
+    // will need (its level pack loaded), so that Load stays fast
+    void Prefetch(Game& game) const;
+
+    // drop the saved session (the run ended)
+    void Remove();
+
+private:
+    void WriterLoop();
+    bool ReadFile(std::vector<unsigned char>& payload, std::string* error) const;
+    static uint64_t Checksum(const unsigned char* data, size_t size);
+
+    std::string m_path;
+    std::vector<unsigned char> m_snapshot;  // reused by SaveAsync
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::vector<unsigned char> m_pending;   // header + payload to write
+    bool m_hasPending;
+    bool m_writing;
+    bool m_stop;
+    bool m_hasSession;
+    std::thread m_writer;
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Stable C interface to the game engine (libsnake_env), for training
+ * pipelines and other languages.
+ *
+ * Observations are SNAKE_ENV_CHANNELS planes of rows x cols bytes
+ * (channel-major, row-major inside a plane), 1 where the channel is present
+ * and 0 elsewhere. They are written straight into the caller's buffer; an
+ * environment never allocates while stepping.
+ *
+ * An environment may be used by one thread at a time. Different
+ * environments are independent and may be stepped concurrently.
+ */
+
+#if defined(_WIN32)
+#  if defined(SNAKE_ENV_BUILD)
+#    define SNAKE_ENV_API __declspec(dllexport)
+#  else
+#    define SNAKE_ENV_API __declspec(dllimport)
+#  endif
+#else
+#  define SNAKE_ENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNAKE_ENV_ABI_VERSION 1
+
+/* observation channels */
+enum {
+    SNAKE_ENV_CH_SNAKE    = 0,  /* every snake cell, head included */
+    SNAKE_ENV_CH_HEAD     = 1,
+    SNAKE_ENV_CH_FOOD     = 2,  /* visible regular and bonus food */
+    SNAKE_ENV_CH_POISON   = 3,  /* visible poison */
+    SNAKE_ENV_CH_OBSTACLE = 4,
+    SNAKE_ENV_CHANNELS    = 5
+};
+
+/* actions: absolute directions; reversing into the snake is ignored */
+enum {
+    SNAKE_ENV_UP    = 0,
+    SNAKE_ENV_DOWN  = 1,
+    SNAKE_ENV_LEFT  = 2,
+    SNAKE_ENV_RIGHT = 3
+};
+
+typedef struct SnakeEnv SnakeEnv;
+
+typedef struct SnakeEnvStep {
+    float reward;    /* points scored this step, SNAKE_ENV_DEATH_REWARD on death */
+    int32_t done;    /* 1 if the episode ended this step */
+    int32_t score;   /* score of the episode (the finished one if done) */
+    int32_t length;  /* snake length */
+} SnakeEnvStep;
+
+#define SNAKE_ENV_DEATH_REWARD (-10.0f)
+
+typedef struct SnakeEnvStats {
+    uint64_t steps;          /* steps taken by all environments */
+    double seconds;          /* time spent inside step calls */
+    double steps_per_second;
+} SnakeEnvStats;
+
+SNAKE_ENV_API int snake_env_abi_version(void);
+
+/* returns NULL if cols or rows is below 8 */
+SNAKE_ENV_API SnakeEnv* snake_env_create(int cols, int rows, uint64_t seed);
+SNAKE_ENV_API void snake_env_destroy(SnakeEnv* env);
+
+/* bytes per observation: SNAKE_ENV_CHANNELS * cols * rows */
+SNAKE_ENV_API size_t snake_env_observation_size(const SnakeEnv* env);
+
+/* start a new episode; obs may be NULL */
+SNAKE_ENV_API void snake_env_reset(SnakeEnv* env, uint64_t seed, uint8_t* obs);
+
+/* advance one tick; obs and result may be NULL. Once done, further steps
+ * are no-ops until the next reset. */
+SNAKE_ENV_API void snake_env_step(SnakeEnv* env, int action, uint8_t* obs,
+                                  SnakeEnvStep* result);
+
+/*
+ * Step count environments at once. actions and results hold count entries;
+ * obs holds count observations back to back (or is NULL). Environments whose
+ * episode ends are reset right away with a seed drawn from their last reset
+ * seed, so obs then shows the new episode while result describes the one
+ * that ended. threads != 0 spreads the work over the internal thread pool.
+ */
+SNAKE_ENV_API void snake_env_step_batch(SnakeEnv* const* envs, int count,
+                                        const int* actions, uint8_t* obs,
+                                        SnakeEnvStep* results, int threads);
+
+/* throughput counters, process-wide */
+SNAKE_ENV_API void snake_env_get_stats(SnakeEnvStats* stats);
+SNAKE_ENV_API void snake_env_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+#include "game.h"
+#include <cstddef>
+#include <cstdint>
+
+// Everything SoftRenderer needs for one frame, copied out of a Game so the
+// frame can be rendered on another thread while the game moves on. The view
+// matches the game window at zoom 1: the whole board centered when it fits,
+// otherwise a window following the head with wrap-around.
+struct FrameState {
+    // cells touched by the 480 px view (20 whole cells plus two halves)
+    static const int VIEW_CELLS = 21;
+
+    enum Cell : uint8_t {
+        SNAKE    = 1,
+        OBSTACLE = 2,
+        FOOD     = 4,
+        HEAD     = 8,
+        POISON   = 16,   // with FOOD
+        GOLD     = 32    // with FOOD: worth more than 10
+    };
+
+    int originX, originY;   // world pixel at the view's top-left corner
+    int x0, y0;             // world cell of cells[0]
+    int cols, rows;         // visible cells, at most VIEW_CELLS each
+    uint8_t cells[VIEW_CELLS * VIEW_CELLS];  // Cell bits, row-major
+
+    bool eye;               // snake has a neck, so the eye is drawn
+    int eyeX, eyeY;         // eye center in screen pixels
+
+    int score, length, level, best;
+
+    // read-only, like the game window: the tick loads the chunks in view
+    void Capture(const Game& game, int highScore);
+};
+
+// CPU rasterizer reproducing the game window's play screen (board, foods,
+// snake and HUD) at 480x560. Frames are drawn as one palette index per
+// pixel, then expanded to RGB24 or YUV 4:2:0. Stateless and thread-safe.
+class SoftRenderer {
+public:
+    static const int WIDTH = 480;
+    static const int HEIGHT = 560;
+    static const size_t PIXELS_SIZE = (size_t)WIDTH * HEIGHT;
+    static const size_t RGB_SIZE = PIXELS_SIZE * 3;
+    // planar YUV 4:2:0 (Y4M C420jpeg frame)
+    static const size_t I420_SIZE = PIXELS_SIZE * 3 / 2;
+
+    // pixels: PIXELS_SIZE palette indices
+    static void Render(const FrameState& frame, uint8_t* pixels);
+
+    static void ToRgb(const uint8_t* pixels, uint8_t* rgb);
+    // BT.601 studio range, chroma averaged over 2x2 blocks
+    static void ToI420(const uint8_t* pixels, uint8_t* yuv);
+};
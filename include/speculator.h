@@ -0,0 +1,145 @@
+#pragma once
+#include "game.h"
+#include "event_stream.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs the next tick ahead of time. A worker thread plays the following tick
+// on three branch games, once for each direction SetDirection can pick
+// (straight on and both turns). Tick then swaps in the branch for the
+// direction the player chose, which costs the same however long Update
+// would have taken, and forwards the events it published; if the worker is
+// on that branch right now, Tick waits for it. Without a usable branch
+// (none started, a direction without one, a game changed since Start, a
+// branch the worker hasn't begun) Tick runs Update, so the game plays out
+// exactly the same either way.
+//
+// The branches persist from tick to tick and nothing is copied: the worker
+// undoes each branch's speculative Update (Game::UndoUpdate) and replays
+// the directions of the ticks played since, and the branch swapped out by a
+// hit holds the game's old state, which only needs the replay. A branch
+// that can't be undone (level change) is copied from one that kept step,
+// on the worker. Only when none kept step (the first Start of a run,
+// Cancel, a state the replay doesn't reach) does Start copy the game, once,
+// on the calling thread.
+//
+// Speculation that costs the calling thread more (Start and Tick) than the
+// plain Updates it replaces is left off, and tried again every PROBE_TICKS
+// ticks; on small boards a plain Update is cheaper than handing it over.
+// On a single core it is never on.
+//
+// The branches publish to private streams and never write the high score
+// file. One Speculator per Game; call everything from the game's thread.
+class Speculator {
+public:
+    struct Stats {
+        uint64_t ticks;         // Tick calls
+        uint64_t hits;          // served from a finished branch
+        uint64_t late;          // the worker hadn't begun the branch
+        uint64_t missed;        // no branch for this state and direction
+        uint64_t skipped;       // not speculated on: it didn't pay
+        uint64_t resyncs;       // Starts that copied the game
+        uint64_t copies;        // branches the worker copied from another
+        double startSeconds;    // Start on the calling thread, resyncs included
+        double hitSeconds;      // Tick time on hits (swap + forwarding)
+        double missSeconds;     // Tick time otherwise (plain Update)
+        double plainSeconds;    // Update time of all ticks (the worker's on hits)
+        double savedSeconds;    // plainSeconds minus all Tick and Start time
+        double worstTickSeconds;    // longest Tick
+        double worstUpdateSeconds;  // longest worker Update of a hit
+    };
+
+    // branches are made for games of this one's board size
+    explicit Speculator(const Game& game);
+    // waits for the worker
+    ~Speculator();
+
+    Speculator(const Speculator&) = delete;
+    Speculator& operator=(const Speculator&) = delete;
+
+    // Speculate on the game's next tick; false (nothing done) if the game
+    // isn't playing, the worker is still on an earlier start or speculation
+    // doesn't pay at the moment
+    bool Start(const Game& game);
+    // a speculation started from this state (direction aside) is pending
+    bool IsCurrent(const Game& game) const;
+    // forget the pending speculation and the branches (rules changed:
+    // difficulty, level pack)
+    void Cancel();
+
+    // advance the game one tick, like game.Update()
+    void Tick(Game& game);
+
+    Stats GetStats() const;
+
+private:
+    // ticks the branches can fall behind between two Starts; replaying
+    // them on the worker beats copying the game on the calling thread
+    static const int MAX_REPLAY = 256;
+    // ticks between two tries while speculation doesn't pay, and between
+    // two jobs that only catch the branches up meanwhile
+    static const int PROBE_TICKS = 64;
+    static const int CATCH_UP_TICKS = 8;
+
+    // where a branch stands against the state the job started from
+    enum class BranchState {
+        LOST,   // somewhere else: copy another branch
+        BASE,   // on it
+        TRIED   // one UpdateUndoable past it
+    };
+
+    // queue the direction of a tick the game played (tick count before/after)
+    void RecordTick(uint64_t before, uint64_t after, Dir dir);
+    // bring branch i to the state Start saw; false if it didn't get there
+    bool CatchUp(int i);
+    void WorkerLoop();
+
+    std::vector<Game> m_branches;    // one per legal direction
+    BranchState m_branchState[3];
+    Dir m_triedDir[3];               // direction of a TRIED branch
+    Dir m_branchDir[3];              // directions of the pending job
+    double m_branchSeconds[3];       // worker Update time per branch
+    EventStream m_streams[3];
+    std::vector<EventReader> m_readers;
+
+    // identifies the state Start saw: tick and the state hash without
+    // the direction
+    bool m_active;
+    uint64_t m_baseTick;
+    uint64_t m_baseKey;
+
+    Stats m_stats;
+    std::atomic<uint64_t> m_copies;  // the worker's branch copies
+    // on one core the worker only takes turns with the game thread
+    bool m_multicore;
+    bool m_skipping;                 // Start declined: it didn't pay
+    // calling-thread time a speculated tick saved (Update minus Tick and
+    // Start), averaged; speculation stays off while it is negative
+    double m_gain;
+    double m_startSeconds;           // Start time since the last Tick
+    int m_sinceProbe;                // ticks not speculated on since
+
+    // directions of the ticks played since the last Start (game's thread)
+    Dir m_replay[MAX_REPLAY];
+    int m_replayCount;
+    bool m_replayLost;               // more ticks than MAX_REPLAY
+    // handed to the worker by Start
+    Dir m_jobReplay[MAX_REPLAY];
+    int m_jobReplayCount;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_branchDone;
+    bool m_pending;                  // Start handed the worker a new job
+    bool m_busy;                     // set by Start, cleared by the worker
+    int m_running;                   // branch the worker is updating, or -1
+    int m_done;                      // branches of the job finished so far
+    bool m_stop;
+    bool m_inStep;                   // some branch can be caught up
+    bool m_cancel;                   // skip the remaining branches
+    std::thread m_worker;
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops.
+// One ParallelFor runs at a time; the calling thread helps out.
+// A ParallelFor started from inside a ParallelFor body (of any pool) runs
+// serially on the calling thread.
+// Background tasks run one per worker whenever no ParallelFor needs it (a
+// pool without workers keeps one thread just for them).
+class ThreadPool {
+public:
+    // threads = 0 -> one per hardware thread
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // run fn(i) for every i in [0, count) and wait for all of them
+    void ParallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+    // Queue fn to run on a worker without waiting for it; a ParallelFor
+    // inside fn runs serially on that worker. Tasks still queued when the
+    // pool is destroyed are dropped.
+    void Submit(std::function<void()> fn);
+
+    // number of threads working on a ParallelFor (workers + caller)
+    unsigned Size() const;
+
+    // process-wide pool, created on first use
+    static ThreadPool& Shared();
+
+private:
+    // tasksOnly: the background thread of a pool without workers
+    void WorkerLoop(bool tasksOnly);
+    void RunItems();
+
+    std::vector<std::thread> m_workers;
+    std::thread m_taskThread;  // only without workers
+    std::mutex m_runMutex;  // serializes ParallelFor calls
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+
+    const std::function<void(size_t)>* m_fn;
+    size_t m_count;
+    std::atomic<size_t> m_next;
+    size_t m_active;        // workers still inside the current job
+    unsigned long m_job;    // bumped for every ParallelFor
+    std::deque<std::function<void()>> m_tasks;  // background tasks, oldest first
+    bool m_stop;
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Handle returned by TimerWheel::Schedule (0 = no timer)
+typedef uint64_t TimerId;
+
+// Hierarchical timer wheel keyed on simulation ticks.
+// 4 levels x 64 slots cover 2^24 ticks; longer delays are clamped.
+// Schedule and Cancel are O(1); Advance costs O(1) per tick plus the
+// expiring timers (and an occasional cascade of one higher-level slot).
+// Nodes live in an index-linked pool, so the wheel is plain copyable data
+// and never allocates while fewer than `capacity` timers are pending.
+class TimerWheel {
+public:
+    explicit TimerWheel(size_t capacity = 256);
+
+    // fire `event`/`arg` after `delay` ticks (delay 0 is treated as 1)
+    TimerId Schedule(uint64_t delay, int event, int arg = 0);
+
+    // returns false if the timer already fired or was cancelled
+    bool Cancel(TimerId id);
+
+    // drop all pending timers (the tick counter keeps running)
+    void Clear();
+    // drop all pending timers and carry on counting from `now` (restoring
+    // a saved game)
+    void Reset(uint64_t now);
+
+    // advance one tick and call onFire(event, arg) for every expiring timer;
+    // onFire may schedule or cancel timers
+    template <typename Fn>
+    void Advance(Fn&& onFire) {
+        Tick();
+        int n;
+        while ((n = PopDue()) >= 0) {
+            onFire(m_nodes[n].event, m_nodes[n].arg);
+        }
+    }
+
+    uint64_t Now() const { return m_now; }
+    size_t Pending() const { return m_pending; }
+
+    // ticks until the timer fires, or -1 if it is not pending
+    int64_t Remaining(TimerId id) const;
+
+    // visit pending timers as fn(remainingTicks, event, arg)
+    template <typename Fn>
+    void ForEach(Fn&& fn) const {
+        for (const auto& node : m_nodes)
+            if (node.list != FREE)
+                fn(node.expires - m_now, node.event, node.arg);
+    }
+
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const int DUE = LEVELS * SLOTS;  // list id of the expired list
+    static const int FREE = -1;             // list id of unused nodes
+
+    struct Node {
+        uint64_t expires;
+        int event;
+        int arg;
+        uint32_t generation;
+        int list;       // slot index, DUE or FREE
+        int prev, next;
+    };
+
+    void Tick();
+    int PopDue();
+    void Place(int n);
+    void Link(int n, int list);
+    void Unlink(int n);
+    void Release(int n);
+    void Cascade(int level);
+    int Lookup(TimerId id) const;
+
+    std::vector<Node> m_nodes;
+    std::vector<int> m_heads;  // LEVELS*SLOTS slot lists + the due list
+    int m_freeHead;
+    uint64_t m_now;
+    size_t m_pending;
+};
@@ -0,0 +1,104 @@
+#pragma once
+#include "pos.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// per-cell occupancy flags kept in the World
+enum CellFlag : unsigned char {
+    CELL_SNAKE    = 1,
+    CELL_OBSTACLE = 2,
+    CELL_FOOD     = 4
+};
+
+// Sparse board storage: CellFlag bytes in 64x64 chunks kept in a hash map and
+// allocated when first written (or first read, for procedural worlds).
+// Memory scales with the area touched, not with cols*rows, so boards up to
+// 1M x 1M cells are fine.
+//
+// In procedural mode each chunk gets obstacles generated from the world seed
+// the first time it is loaded. Such chunks can be evicted once they hold
+// nothing but obstacles; reloading regenerates the same layout.
+class World {
+public:
+    static const int CHUNK_BITS = 6;
+    static const int CHUNK_SIZE = 1 << CHUNK_BITS;  // 64x64 cells
+
+    World(int cols, int rows);
+
+    // enable per-chunk obstacle generation; cells in [clearMin, clearMax]
+    // (the spawn area) never get obstacles
+    void EnableProcedural(uint64_t seed, Pos clearMin, Pos clearMax);
+    bool IsProcedural() const { return m_procedural; }
+    uint64_t GetSeed() const { return m_seed; }
+
+    // CellFlag bits at p (loads the chunk in procedural mode)
+    unsigned char Get(Pos p);
+    // like Get, but never loads: unloaded chunks read as empty
+    unsigned char Peek(Pos p) const;
+    // Peek `count` cells of row y from x on (not wrapping) into out, with
+    // one chunk lookup per chunk instead of one per cell
+    void PeekRow(int y, int x, int count, unsigned char* out) const;
+    void SetFlags(Pos p, unsigned char flags);
+    void ClearFlags(Pos p, unsigned char flags);
+
+    // load (generate) the procedural chunks within `radius` chunks of
+    // `center`, so Peek sees them
+    void LoadAround(Pos center, int radius);
+    // drop procedural chunks farther than `radius` chunks from `center`
+    // that contain nothing but generated obstacles
+    void EvictFar(Pos center, int radius);
+
+    // remove all non-obstacle flags and unload everything that can be
+    // regenerated (used on restart)
+    void Reset();
+
+    // Undo for speculative ticks: between StartJournal and StopJournal,
+    // SetFlags and ClearFlags note each cell's old flags, and RollBack puts
+    // them back. StopJournal is false if there were too many to note; the
+    // changes can't be rolled back then. Copies don't take the journal.
+    void StartJournal();
+    bool StopJournal();
+    void RollBack();
+
+    size_t LoadedChunks() const { return m_chunks.size(); }
+    size_t MemoryBytes() const { return m_chunks.size() * sizeof(Chunk); }
+
+    World(const World& other);
+    World& operator=(const World& other);
+    // moves keep the chunks (and the lookup cache pointing into them)
+    World(World&& other) noexcept;
+    World& operator=(World&& other) noexcept;
+
+private:
+    struct Chunk {
+        unsigned char cells[CHUNK_SIZE * CHUNK_SIZE];
+        int dynamicCells;  // cells carrying anything but CELL_OBSTACLE
+    };
+
+    static uint64_t Key(int cx, int cy);
+    Chunk* Find(Pos p);
+    Chunk& Load(Pos p);
+    void Generate(int cx, int cy, Chunk& chunk) const;
+    static int Local(Pos p);
+    void Note(Pos p, unsigned char flags);
+
+    int m_cols, m_rows;
+    bool m_procedural;
+    uint64_t m_seed;
+    Pos m_clearMin, m_clearMax;
+    std::unordered_map<uint64_t, Chunk> m_chunks;
+
+    // last chunk looked up; map nodes are stable until erased
+    uint64_t m_cacheKey;
+    Chunk* m_cache;
+
+    struct JournalEntry {
+        Pos pos;
+        unsigned char flags;  // before the change
+    };
+    std::vector<JournalEntry> m_journal;  // reserved by the first StartJournal
+    bool m_journaling;
+    bool m_journalFull;
+};
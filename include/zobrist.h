@@ -0,0 +1,20 @@
+#pragma once
+#include "pos.h"
+#include <cstdint>
+
+// Zobrist keys for the game state hash.
+// Keys are derived from a fixed mixing function instead of random tables,
+// so every build and every client agrees on them and no memory is spent
+// per board cell.
+class Zobrist {
+public:
+    static uint64_t SnakeCell(Pos p);
+    static uint64_t SnakeHead(Pos p);
+    static uint64_t Obstacle(Pos p);
+    static uint64_t Direction(int dir);
+    static uint64_t WorldSeed(uint64_t seed);
+
+    // slot = index of the food in Game::GetFoods()
+    static uint64_t Food(int slot, Pos p);
+    static uint64_t HiddenFood(int slot);
+};
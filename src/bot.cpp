@@ -0,0 +1,100 @@
+#include "bot.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+const Dir DIRS[4] = {Dir::UP, Dir::DOWN, Dir::LEFT, Dir::RIGHT};
+
+Dir Opposite(Dir d) {
+    switch (d) {
+    case Dir::UP:    return Dir::DOWN;
+    case Dir::DOWN:  return Dir::UP;
+    case Dir::LEFT:  return Dir::RIGHT;
+    case Dir::RIGHT: return Dir::LEFT;
+    }
+    return d;
+}
+
+Pos Step(Pos p, Dir d, int cols, int rows) {
+    switch (d) {
+    case Dir::UP:    p.y = (p.y + rows - 1) % rows; break;
+    case Dir::DOWN:  p.y = (p.y + 1) % rows; break;
+    case Dir::LEFT:  p.x = (p.x + cols - 1) % cols; break;
+    case Dir::RIGHT: p.x = (p.x + 1) % cols; break;
+    }
+    return p;
+}
+
+// shortest distance along one wrapping axis
+int WrapDistance(int a, int b, int size) {
+    int d = abs(a - b);
+    return d < size - d ? d : size - d;
+}
+
+} // namespace
+
+Bot::Bot(uint64_t seed)
+    : m_rng(seed),
+      m_mistakeRate(0.0f)
+{
+}
+
+void Bot::SetMistakeRate(float rate) {
+    m_mistakeRate = rate;
+}
+
+Dir Bot::Choose(const Game& game) {
+    const int cols = game.GetCols();
+    const int rows = game.GetRows();
+    const Pos head = game.GetSnake().front();
+    const Dir current = game.GetDirection();
+
+    Dir moves[3];
+    int moveCount = 0;
+    for (Dir d : DIRS)
+        if (d != Opposite(current)) moves[moveCount++] = d;
+
+    if (m_mistakeRate > 0.0f && m_rng.Uniform() < m_mistakeRate)
+        return moves[m_rng.Below(moveCount)];
+
+    // nearest regular food (poison is avoided like an obstacle)
+    const Food* target = nullptr;
+    int targetDist = 0;
+    for (const auto& f : game.GetFoods()) {
+        if (!f.IsVisible() || f.IsPoison()) continue;
+        Pos p = f.GetPosition();
+        int dist = WrapDistance(p.x, head.x, cols) + WrapDistance(p.y, head.y, rows);
+        if (!target || dist < targetDist) { target = &f; targetDist = dist; }
+    }
+
+    const int length = (int)game.GetSnake().size();
+    Dir best = moves[m_rng.Below(moveCount)];
+    int bestScore = -1;
+    for (int i = 0; i < moveCount; ++i) {
+        Pos next = Step(head, moves[i], cols, rows);
+        unsigned char flags = game.PeekCellFlags(next);
+        if (flags & (CELL_SNAKE | CELL_OBSTACLE)) continue;
+
+        bool poison = false;
+        for (const auto& f : game.GetFoods()) {
+            Pos p = f.GetPosition();
+            if (f.IsVisible() && f.IsPoison() && p.x == next.x && p.y == next.y) poison = true;
+        }
+
+        // safe moves always beat unsafe ones; moves into a region too small
+        // for the snake (a dead end) come next, roomier ones first; then
+        // closer to food beats farther; random tie break
+        int score = 1 << 20;
+        int region = game.GetRegionAhead(moves[i]);
+        if (region >= 0 && region < length) score -= (1 << 18) - std::min(region, 1 << 12) * 32;
+        if (target) {
+            Pos p = target->GetPosition();
+            score -= (WrapDistance(p.x, next.x, cols) + WrapDistance(p.y, next.y, rows)) * 8;
+        }
+        if (poison) score -= 1 << 16;
+        score += m_rng.Below(8);
+        if (score > bestScore) { bestScore = score; best = moves[i]; }
+    }
+    return best;
+}
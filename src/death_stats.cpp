@@ -0,0 +1,215 @@
+#include "death_stats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+DeathStats::DeathStats(int cols, int rows)
+    : m_cols(cols),
+      m_rows(rows),
+      m_cells((size_t)MAX_LEVELS * cols * rows, 0),
+      m_layouts((size_t)MAX_LEVELS * cols * rows, 0),
+      m_hasLayout(MAX_LEVELS, 0),
+      m_levels(MAX_LEVELS, LevelTotals{{0, 0}, 0, 0, 0}),
+      m_ticks((size_t)(TICK_BUCKETS + 1) * 2, 0),
+      m_survivors(0)
+{
+}
+
+int DeathStats::LevelBucket(int level) {
+    if (level < 1) level = 1;
+    return (level > MAX_LEVELS ? MAX_LEVELS : level) - 1;
+}
+
+int DeathStats::TickBucket(uint64_t ticks) {
+    // TICK_BUCKETS is the overflow bucket
+    uint64_t b = ticks / TICK_BUCKET;
+    return b >= (uint64_t)TICK_BUCKETS ? TICK_BUCKETS : (int)b;
+}
+
+void DeathStats::RememberLayout(const Game& game, int bucket) {
+    // the first game to end on a level records its layout
+    if (m_hasLayout[bucket]) return;
+    m_hasLayout[bucket] = 1;
+    uint8_t* layout = &m_layouts[(size_t)bucket * m_cols * m_rows];
+    for (const auto& p : game.GetObstacles()) layout[(size_t)p.y * m_cols + p.x] = 1;
+}
+
+void DeathStats::AddDeath(const Game& game, uint64_t ticks) {
+    int bucket = LevelBucket(game.GetLevel());
+    int cause = game.GetDeathCause() == DeathCause::SELF ? 0 : 1;
+    Pos cell = game.GetDeathCell();
+
+    m_cells[((size_t)bucket * m_rows + cell.y) * m_cols + cell.x]++;
+    RememberLayout(game, bucket);
+
+    LevelTotals& totals = m_levels[bucket];
+    totals.deaths[cause]++;
+    totals.lengthSum += game.GetSnake().size();
+    totals.tickSum += ticks;
+
+    m_ticks[(size_t)TickBucket(ticks) * 2 + cause]++;
+}
+
+void DeathStats::AddSurvivor(const Game& game, uint64_t /*ticks*/) {
+    int bucket = LevelBucket(game.GetLevel());
+    RememberLayout(game, bucket);
+    m_levels[bucket].survivors++;
+    m_survivors++;
+}
+
+void DeathStats::Merge(const DeathStats& other) {
+    for (size_t i = 0; i < m_cells.size(); ++i) m_cells[i] += other.m_cells[i];
+    for (int l = 0; l < MAX_LEVELS; ++l) {
+        if (!m_hasLayout[l] && other.m_hasLayout[l]) {
+            size_t plane = (size_t)m_cols * m_rows;
+            std::copy(other.m_layouts.begin() + l * plane, other.m_layouts.begin() + (l + 1) * plane,
+                      m_layouts.begin() + l * plane);
+            m_hasLayout[l] = 1;
+        }
+        LevelTotals& a = m_levels[l];
+        const LevelTotals& b = other.m_levels[l];
+        a.deaths[0] += b.deaths[0];
+        a.deaths[1] += b.deaths[1];
+        a.survivors += b.survivors;
+        a.lengthSum += b.lengthSum;
+        a.tickSum += b.tickSum;
+    }
+    for (size_t i = 0; i < m_ticks.size(); ++i) m_ticks[i] += other.m_ticks[i];
+    m_survivors += other.m_survivors;
+}
+
+uint64_t DeathStats::Games() const {
+    return Deaths() + m_survivors;
+}
+
+uint64_t DeathStats::Deaths() const {
+    return Deaths(DeathCause::SELF) + Deaths(DeathCause::OBSTACLE);
+}
+
+uint64_t DeathStats::Deaths(DeathCause cause) const {
+    if (cause == DeathCause::NONE) return 0;
+    int c = cause == DeathCause::SELF ? 0 : 1;
+    uint64_t n = 0;
+    for (const auto& totals : m_levels) n += totals.deaths[c];
+    return n;
+}
+
+int DeathStats::MaxLevel() const {
+    for (int l = MAX_LEVELS - 1; l >= 0; --l) {
+        const LevelTotals& t = m_levels[l];
+        if (t.deaths[0] + t.deaths[1] + t.survivors > 0) return l + 1;
+    }
+    return 0;
+}
+
+bool DeathStats::WriteHeatmap(const std::string& path, std::string& error) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) { error = path + ": cannot write"; return false; }
+
+    const size_t plane = (size_t)m_cols * m_rows;
+    auto deathsAt = [&](size_t cell) {
+        uint64_t n = 0;
+        for (int l = 0; l < MAX_LEVELS; ++l) n += m_cells[l * plane + cell];
+        return n;
+    };
+
+    uint64_t peak = 0;
+    for (size_t i = 0; i < plane; ++i) peak = std::max(peak, deathsAt(i));
+    double scale = peak > 0 ? 255.0 / std::log1p((double)peak) : 0.0;
+
+    out << "P5\n" << m_cols << " " << m_rows << "\n255\n";
+    std::vector<uint8_t> row(m_cols);
+    for (int y = 0; y < m_rows; ++y) {
+        for (int x = 0; x < m_cols; ++x)
+            row[x] = (uint8_t)(std::log1p((double)deathsAt((size_t)y * m_cols + x)) * scale + 0.5);
+        out.write((const char*)row.data(), row.size());
+    }
+    if (!out) { error = path + ": write failed"; return false; }
+    return true;
+}
+
+bool DeathStats::WriteLevelHeatmap(const std::string& path, int level, std::string& error) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) { error = path + ": cannot write"; return false; }
+
+    const int bucket = LevelBucket(level);
+    const size_t plane = (size_t)m_cols * m_rows;
+    const uint32_t* cells = &m_cells[bucket * plane];
+    const uint8_t* layout = &m_layouts[bucket * plane];
+
+    uint32_t peak = 0;
+    for (size_t i = 0; i < plane; ++i) peak = std::max(peak, cells[i]);
+    double scale = peak > 0 ? 1.0 / std::log1p((double)peak) : 0.0;
+
+    out << "P6\n" << m_cols << " " << m_rows << "\n255\n";
+    std::vector<uint8_t> row((size_t)m_cols * 3);
+    for (int y = 0; y < m_rows; ++y) {
+        for (int x = 0; x < m_cols; ++x) {
+            size_t i = (size_t)y * m_cols + x;
+            uint8_t* px = &row[(size_t)x * 3];
+            if (layout[i]) {
+                px[0] = 40; px[1] = 70; px[2] = 200;
+            } else if (cells[i] == 0) {
+                px[0] = px[1] = px[2] = 16;
+            } else {
+                // red for rare deaths up to yellow for the deadliest cell
+                double t = std::log1p((double)cells[i]) * scale;
+                px[0] = (uint8_t)(96 + 159 * std::min(1.0, t * 2.0));
+                px[1] = (uint8_t)(255 * std::max(0.0, t * 2.0 - 1.0));
+                px[2] = 0;
+            }
+        }
+        out.write((const char*)row.data(), row.size());
+    }
+    if (!out) { error = path + ": write failed"; return false; }
+    return true;
+}
+
+bool DeathStats::WriteSurvivalCsv(const std::string& path, std::string& error) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) { error = path + ": cannot write"; return false; }
+
+    const uint64_t games = Games();
+    out << "tick,alive,deaths_self,deaths_obstacle\n";
+    uint64_t dead = 0;
+    for (int b = 0; b <= TICK_BUCKETS; ++b) {
+        uint64_t self = m_ticks[b * 2];
+        uint64_t obstacle = m_ticks[b * 2 + 1];
+        // the overflow row only exists if some game died that late
+        if (b == TICK_BUCKETS && self + obstacle == 0) break;
+        dead += self + obstacle;
+        double alive = games > 0 ? 1.0 - (double)dead / games : 0.0;
+        char tick[24];
+        if (b < TICK_BUCKETS) snprintf(tick, sizeof(tick), "%d", (b + 1) * TICK_BUCKET);
+        else snprintf(tick, sizeof(tick), ">=%d", TICK_BUCKETS * TICK_BUCKET);
+        char line[96];
+        snprintf(line, sizeof(line), "%s,%.6f,%llu,%llu\n", tick, alive,
+                 (unsigned long long)self, (unsigned long long)obstacle);
+        out << line;
+    }
+    if (!out) { error = path + ": write failed"; return false; }
+    return true;
+}
+
+bool DeathStats::WriteLevelCsv(const std::string& path, std::string& error) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) { error = path + ": cannot write"; return false; }
+
+    out << "level,deaths_self,deaths_obstacle,survivors,mean_length,mean_ticks\n";
+    for (int l = 0; l < MAX_LEVELS; ++l) {
+        const LevelTotals& t = m_levels[l];
+        uint64_t deaths = t.deaths[0] + t.deaths[1];
+        if (deaths + t.survivors == 0) continue;
+        double meanLength = deaths > 0 ? (double)t.lengthSum / deaths : 0.0;
+        double meanTicks = deaths > 0 ? (double)t.tickSum / deaths : 0.0;
+        char line[160];
+        snprintf(line, sizeof(line), "%d%s,%llu,%llu,%llu,%.2f,%.1f\n", l + 1,
+                 l + 1 == MAX_LEVELS ? "+" : "",
+                 (unsigned long long)t.deaths[0], (unsigned long long)t.deaths[1],
+                 (unsigned long long)t.survivors, meanLength, meanTicks);
+        out << line;
+    }
+    if (!out) { error = path + ": write failed"; return false; }
+    return true;
+}
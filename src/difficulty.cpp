@@ -0,0 +1,91 @@
+#include "difficulty.h"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+DifficultyConfig::DifficultyConfig()
+    : pointsPerLevel(50),
+      baseTick(0.12f),
+      tickStep(0.01f),
+      minTick(0.03f),
+      foodValue(10),
+      bonusFoodValue(15),
+      poisonValue(-10),
+      levelBonusFood(20),
+      bonusEvery(3)
+{
+}
+
+float DifficultyConfig::TickSeconds(int level) const {
+    float speed = baseTick - tickStep * (level - 1);
+    return speed < minTick ? minTick : speed;
+}
+
+uint64_t DifficultyConfig::Hash() const {
+    // floats go in by bit pattern, so any change in a saved value shows
+    uint32_t fields[] = {
+        (uint32_t)pointsPerLevel, 0, 0, 0, (uint32_t)foodValue, (uint32_t)bonusFoodValue,
+        (uint32_t)poisonValue, (uint32_t)levelBonusFood, (uint32_t)bonusEvery,
+    };
+    memcpy(&fields[1], &baseTick, sizeof(float));
+    memcpy(&fields[2], &tickStep, sizeof(float));
+    memcpy(&fields[3], &minTick, sizeof(float));
+
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (uint32_t v : fields) {
+        for (int b = 0; b < 4; ++b) {
+            h ^= (v >> (8 * b)) & 0xFF;
+            h *= 0x100000001B3ull;
+        }
+    }
+    return h;
+}
+
+bool DifficultyConfig::Load(const std::string& path, std::string& error) {
+    std::ifstream in(path);
+    if (!in) { error = path + ": cannot open"; return false; }
+
+    DifficultyConfig cfg = *this;
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        std::istringstream ls(line);
+        std::string key;
+        if (!(ls >> key) || key[0] == '#') continue;
+
+        bool ok;
+        if (key == "points_per_level")      ok = (bool)(ls >> cfg.pointsPerLevel) && cfg.pointsPerLevel > 0;
+        else if (key == "base_tick")        ok = (bool)(ls >> cfg.baseTick) && cfg.baseTick > 0;
+        else if (key == "tick_step")        ok = (bool)(ls >> cfg.tickStep) && cfg.tickStep >= 0;
+        else if (key == "min_tick")         ok = (bool)(ls >> cfg.minTick) && cfg.minTick > 0;
+        else if (key == "food")             ok = (bool)(ls >> cfg.foodValue);
+        else if (key == "bonus_food")       ok = (bool)(ls >> cfg.bonusFoodValue);
+        else if (key == "poison")           ok = (bool)(ls >> cfg.poisonValue) && cfg.poisonValue <= 0;
+        else if (key == "level_bonus_food") ok = (bool)(ls >> cfg.levelBonusFood);
+        else if (key == "bonus_every")      ok = (bool)(ls >> cfg.bonusEvery) && cfg.bonusEvery > 0;
+        else { error = path + ":" + std::to_string(lineNo) + ": unknown key '" + key + "'"; return false; }
+
+        if (!ok) { error = path + ":" + std::to_string(lineNo) + ": bad " + key; return false; }
+    }
+
+    *this = cfg;
+    return true;
+}
+
+bool DifficultyConfig::Save(const std::string& path, std::string& error) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) { error = path + ": cannot write"; return false; }
+    out << "# Snake difficulty (levels not defined by the level pack)\n"
+        << "points_per_level " << pointsPerLevel << "\n"
+        << "base_tick " << baseTick << "\n"
+        << "tick_step " << tickStep << "\n"
+        << "min_tick " << minTick << "\n"
+        << "food " << foodValue << "\n"
+        << "bonus_food " << bonusFoodValue << "\n"
+        << "poison " << poisonValue << "\n"
+        << "level_bonus_food " << levelBonusFood << "\n"
+        << "bonus_every " << bonusEvery << "\n";
+    if (!out) { error = path + ": write failed"; return false; }
+    return true;
+}
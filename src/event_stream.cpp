@@ -0,0 +1,80 @@
+#include "event_stream.h"
+#include <cstring>
+
+static_assert((EventStream::CAPACITY & (EventStream::CAPACITY - 1)) == 0,
+              "EventStream::CAPACITY must be a power of two");
+
+EventStream::EventStream()
+    : m_head(0)
+{
+    for (auto& slot : m_slots) {
+        slot.version.store(0, std::memory_order_relaxed);
+        for (auto& w : slot.words) w.store(0, std::memory_order_relaxed);
+    }
+}
+
+void EventStream::Publish(const GameEvent& event) {
+    uint64_t seq = m_head.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[seq & (CAPACITY - 1)];
+
+    uint64_t words[WORDS] = {};
+    memcpy(words, &event, sizeof(GameEvent));
+
+    slot.version.store(2 * seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < WORDS; ++i) slot.words[i].store(words[i], std::memory_order_relaxed);
+    slot.version.store(2 * seq + 2, std::memory_order_release);
+
+    m_head.store(seq + 1, std::memory_order_release);
+}
+
+uint64_t EventStream::Head() const {
+    return m_head.load(std::memory_order_acquire);
+}
+
+bool EventStream::Read(uint64_t seq, GameEvent& out) const {
+    const Slot& slot = m_slots[seq & (CAPACITY - 1)];
+    if (slot.version.load(std::memory_order_acquire) != 2 * seq + 2) return false;
+
+    uint64_t words[WORDS];
+    for (size_t i = 0; i < WORDS; ++i) words[i] = slot.words[i].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // the producer may have started overwriting the slot meanwhile
+    if (slot.version.load(std::memory_order_relaxed) != 2 * seq + 2) return false;
+
+    memcpy(&out, words, sizeof(GameEvent));
+    return true;
+}
+
+EventReader::EventReader(const EventStream& stream)
+    : m_stream(&stream),
+      m_next(stream.Head()),
+      m_dropped(0)
+{
+}
+
+bool EventReader::Next(GameEvent& out) {
+    for (;;) {
+        uint64_t head = m_stream->Head();
+        if (m_next >= head) return false;
+
+        // lapped: skip to the oldest event that can still be intact
+        if (head - m_next > EventStream::CAPACITY) {
+            uint64_t oldest = head - EventStream::CAPACITY;
+            m_dropped += oldest - m_next;
+            m_next = oldest;
+        }
+
+        if (m_stream->Read(m_next, out)) {
+            m_next++;
+            return true;
+        }
+        // overwritten while reading: count it and try the next one
+        m_dropped++;
+        m_next++;
+    }
+}
+
+uint64_t EventReader::Dropped() const {
+    return m_dropped;
+}
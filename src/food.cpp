@@ -1,14 +1,10 @@
 #include "food.h"
-#include <ctime>
 
 Food::Food(int cols, int rows, int value, bool isPoison)
-    : m_cols(cols), m_rows(rows), m_value(value), m_isPoison(isPoison), 
-      m_visible(true), m_respawnCounter(0)
+    : m_cols(cols), m_rows(rows), m_pos{0, 0}, m_value(value), m_isPoison(isPoison), 
+      m_visible(true)
 {
-    // seed only first time; safe even if called multiple times
-    static bool seeded = false;
-    if (!seeded) { srand((unsigned)time(nullptr)); seeded = true; }
-    Respawn({});
+    // position is picked by the first Respawn
 }
 
 Pos Food::GetPosition() const {
@@ -19,6 +15,10 @@ int Food::GetValue() const {
     return m_value;
 }
 
+void Food::SetValue(int value) {
+    m_value = value;
+}
+
 bool Food::IsPoison() const {
     return m_isPoison;
 }
@@ -27,47 +27,44 @@ bool Food::IsVisible() const {
     return m_visible;
 }
 
-void Food::Respawn(const std::vector<Pos>& snake,
-                   const std::vector<Pos>& otherFoodsPositions)
+void Food::Hide() {
+    m_visible = false;
+}
+
+void Food::Restore(Pos pos, bool visible) {
+    m_pos = pos;
+    m_visible = visible;
+}
+
+void Food::Respawn(World& world, Rng& rng, Pos areaMin, int areaCols, int areaRows,
+                   const Reachability* reach, Pos from)
 {
-    // Poison food spawns less frequently (1 in 5 times)
-    if (m_isPoison) {
-        m_respawnCounter++;
-        if (m_respawnCounter < 5) {
-            m_visible = false;
-            return; // Don't spawn yet
-        }
-        m_respawnCounter = 0; // Reset counter
-        m_visible = true;
-    }
+    m_visible = true;
+
+    auto isFree = [&](int dx, int dy, Pos& out) {
+        out.x = (areaMin.x + dx) % m_cols;
+        out.y = (areaMin.y + dy) % m_rows;
+        return world.Get(out) == 0 && (!reach || reach->Reachable(from, out));
+    };
+    Pos p;
     
     // try random positions until a free one is found (with a fallback)
     const int MAX_ATTEMPTS = 1000;
     int attempts = 0;
     while (attempts++ < MAX_ATTEMPTS) {
-        m_pos.x = rand() % m_cols;
-        m_pos.y = rand() % m_rows;
-
-        bool conflict = false;
-        for (const auto& p : snake) {
-            if (p.x == m_pos.x && p.y == m_pos.y) { conflict = true; break; }
-        }
-        if (conflict) continue;
-
-        for (const auto& p : otherFoodsPositions) {
-            if (p.x == m_pos.x && p.y == m_pos.y) { conflict = true; break; }
-        }
-        if (!conflict) return;
+        if (isFree(rng.Below(areaCols), rng.Below(areaRows), p)) { m_pos = p; return; }
     }
 
-    // fallback: linear scan for free cell (deterministic)
-    for (int y = 0; y < m_rows; ++y) {
-        for (int x = 0; x < m_cols; ++x) {
-            bool conflict = false;
-            for (const auto& p : snake) if (p.x == x && p.y == y) { conflict = true; break; }
-            for (const auto& p : otherFoodsPositions) if (p.x == x && p.y == y) { conflict = true; break; }
-            if (!conflict) { m_pos.x = x; m_pos.y = y; return; }
+    // fallback: linear scan for free cell (deterministic); when the head
+    // is sealed off with no free cell left, any free cell will do
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int y = 0; y < areaRows; ++y) {
+            for (int x = 0; x < areaCols; ++x) {
+                if (isFree(x, y, p)) { m_pos = p; return; }
+            }
         }
+        if (!reach) break;
+        reach = nullptr;
     }
     // if everything fails (very unlikely) keep previous position
 }
\ No newline at end of file
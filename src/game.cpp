@@ -1,7 +1,127 @@
 #include "game.h"
+#include "zobrist.h"
+#include "level_generator.h"
+#include "thread_pool.h"
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
 #include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <utility>
+
+// the hand-coded layouts stay below this
+static const size_t MAX_HAND_CODED_OBSTACLES = 128;
+// the level 3 bonus food stops being added past this many foods
+static const size_t MAX_FOODS = 5;
+// poison stays hidden this many ticks after a restart or after being eaten
+static const uint64_t POISON_SPAWN_DELAY = 100;
+// never reserve more snake than this up front (huge boards grow on demand)
+static const size_t MAX_SNAKE_RESERVE = 1 << 20;
+// on boards larger than this, food spawns in a window this wide around the head
+static const int SPAWN_WINDOW = 64;
+// procedural chunks farther than this (in chunks) from the head are evicted
+static const int EVICT_RADIUS = 4;
+// procedural chunks this close to the head are loaded by the tick; covers
+// the board view (drawn with PeekCellFlags) at every zoom it is used for
+static const int LOAD_RADIUS = 2;
+// levels past the hand-coded ones (or on other board sizes) are generated
+// from this seed, so every run and every client sees the same layouts
+static const uint64_t LEVEL_SEED = 0x5EED0F1E7E15ull;
+static const int HAND_CODED_LEVELS = 5;
+// LevelGenerator::TargetDifficulty stops rising at this level; later levels
+// reuse its layout
+static const int GENERATED_LEVELS = 15;
+
+// Every generated layout for one board size, indexed by level (hand-coded
+// levels stay empty). They depend only on the board size, so all games of a
+// size share one set. A game builds the level it starts on itself; the rest
+// are built by background tasks on the shared pool while it plays. A level
+// reached before its task ran is built by the game that needs it. Finished
+// layouts never change and are read without locking.
+struct GeneratedLevelSet {
+    enum Builder : uint8_t { NONE, BACKGROUND, GAME };
+
+    int cols, rows;
+    std::mutex mutex;
+    std::condition_variable built;
+    Builder builder[GENERATED_LEVELS + 1] = {};
+    std::unique_ptr<const std::vector<Pos>> owned[GENERATED_LEVELS + 1];
+    std::atomic<const std::vector<Pos>*> layouts[GENERATED_LEVELS + 1] = {};
+    std::atomic<bool> queued{false};
+};
+
+static std::shared_ptr<GeneratedLevelSet> GeneratedLevels(int cols, int rows) {
+    static std::mutex mutex;
+    static std::map<std::pair<int, int>, std::shared_ptr<GeneratedLevelSet>> cache;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<GeneratedLevelSet>& set = cache[{cols, rows}];
+    if (!set) {
+        set = std::make_shared<GeneratedLevelSet>();
+        set->cols = cols;
+        set->rows = rows;
+    }
+    return set;
+}
+
+static bool IsHandCoded(int cols, int rows, int level) {
+    return cols == 20 && rows == 20 && level <= HAND_CODED_LEVELS;
+}
+
+static const std::vector<Pos>* BuildGeneratedLevel(GeneratedLevelSet& set, int level) {
+    int centerX = set.cols / 2;
+    int centerY = set.rows / 2;
+    std::unique_ptr<const std::vector<Pos>> layout(new std::vector<Pos>(
+        LevelGenerator::Generate(set.cols, set.rows, level, LEVEL_SEED,
+                                 {centerX - 3, centerY - 2}, {centerX + 3, centerY + 2})));
+    std::lock_guard<std::mutex> lock(set.mutex);
+    // two games building the same level get the same layout; keep the first
+    if (!set.owned[level]) {
+        set.layouts[level].store(layout.get(), std::memory_order_release);
+        set.owned[level] = std::move(layout);
+    }
+    set.built.notify_all();
+    return set.owned[level].get();
+}
+
+// the layout of `level`, built on this thread if nobody has started it
+static const std::vector<Pos>& GeneratedLayout(GeneratedLevelSet& set, int level) {
+    if (const std::vector<Pos>* layout = set.layouts[level].load(std::memory_order_acquire))
+        return *layout;
+
+    std::unique_lock<std::mutex> lock(set.mutex);
+    if (set.builder[level] == GeneratedLevelSet::BACKGROUND) {
+        // background builds run serially on their worker and always finish
+        set.built.wait(lock, [&] { return set.layouts[level].load() != nullptr; });
+        return *set.layouts[level].load();
+    }
+    // Another game building it may be waiting for the pool in its own
+    // ParallelFor, so don't wait on it; build a copy instead.
+    if (set.builder[level] == GeneratedLevelSet::NONE) set.builder[level] = GeneratedLevelSet::GAME;
+    lock.unlock();
+    return *BuildGeneratedLevel(set, level);
+}
+
+// queue background builds of every level, `first` first and then upwards;
+// only the first game of a board size does
+static void QueueGeneratedLevels(const std::shared_ptr<GeneratedLevelSet>& set, int first) {
+    if (set->queued.exchange(true)) return;
+    for (int i = 0; i < GENERATED_LEVELS; ++i) {
+        int level = (first - 1 + i) % GENERATED_LEVELS + 1;
+        if (IsHandCoded(set->cols, set->rows, level)) continue;
+        ThreadPool::Shared().Submit([set, level] {
+            {
+                std::lock_guard<std::mutex> lock(set->mutex);
+                if (set->builder[level] != GeneratedLevelSet::NONE) return;
+                set->builder[level] = GeneratedLevelSet::BACKGROUND;
+            }
+            BuildGeneratedLevel(*set, level);
+        });
+    }
+}
 
 Game::Game(int cols, int rows, int initialFoodCount)
     : m_cols(cols),
@@ -9,65 +129,125 @@ Game::Game(int cols, int rows, int initialFoodCount)
       m_dir(Dir::RIGHT),
       m_grow(false),
       m_gameOver(false),
+      m_deathCause(DeathCause::NONE),
+      m_deathCell{0, 0},
       m_paused(false),
       m_score(0),
       m_level(1),
       m_speed(0.12f),
+      m_hash(0),
+      m_world(cols, rows),
+      m_reach(cols, rows),
+      m_rng((uint64_t)time(nullptr)),
+      m_startSeed(0),
       m_highScore(0),
       m_highScoreFile("highscore.txt"),
-      m_state(GameState::MENU)  // Start in menu
+      m_state(GameState::MENU),  // Start in menu
+      m_events(nullptr)
 {
-    srand((unsigned)time(nullptr));
+    // Reserve everything the simulation can grow into, so that after Restart()
+    // no tick touches the heap: the snake can at most fill the board.
+    // (World preallocates its chunks for all but huge boards.)
+    m_snake.reserve(std::min<size_t>((size_t)m_cols * m_rows, MAX_SNAKE_RESERVE));
+    ReserveObstacles();
+    m_foods.reserve(std::max<size_t>(MAX_FOODS, initialFoodCount + 1));
+
     // create initial foods (different values possible)
-    // Include 1 poison food (spawns 5x less often via respawn logic)
+    // Include 1 poison food (shown on a timer, see POISON_SPAWN_DELAY)
     m_foods.clear();
     for (int i = 0; i < initialFoodCount; ++i) {
-        int val = (i == 0) ? 10 : 15; // second food a bit more valuable
+        // second food a bit more valuable
+        int val = (i == 0) ? m_difficulty.foodValue : m_difficulty.bonusFoodValue;
         m_foods.emplace_back(m_cols, m_rows, val);
     }
     // Add one poison food (negative value, spawns less frequently)
-    m_foods.emplace_back(m_cols, m_rows, -10, true); // true = poison food
+    m_foods.emplace_back(m_cols, m_rows, m_difficulty.poisonValue, true); // true = poison food
     
     LoadHighScore();
     // Don't call Restart() here - wait for user to start from menu
     
     // Initialize snake for preview (optional)
+    ResetSnake();
+    for (size_t i = 0; i < m_foods.size(); ++i) RespawnFood(i);
+
+    m_hash = ComputeStateHash();
+}
+
+void Game::EnableProceduralWorld(uint64_t seed) {
+    // keep the same spawn area clear as the hand-coded levels
+    int centerX = m_cols / 2;
+    int centerY = m_rows / 2;
+    m_world.EnableProcedural(seed, {centerX - 3, centerY - 2}, {centerX + 3, centerY + 2});
+    m_reach.Disable();
+    m_obstacles.clear();
+    Restart();
+}
+
+void Game::SetSeed(uint64_t seed) {
+    m_rng.Seed(seed);
+}
+
+uint64_t Game::GetStartSeed() const {
+    return m_startSeed;
+}
+
+void Game::SetHighScoreFile(const std::string& path) {
+    m_highScoreFile = path;
+    LoadHighScore();
+}
+
+void Game::ResetSnake() {
+    // callers clear the old snake's cells (World::Reset) first
     m_snake.clear();
     m_snake.push_back({m_cols / 2, m_rows / 2});
     m_snake.push_back({m_cols / 2 - 1, m_rows / 2});
     m_snake.push_back({m_cols / 2 - 2, m_rows / 2});
+    for (const auto& p : m_snake) m_world.SetFlags(p, CELL_SNAKE);
 }
 
 void Game::Restart() {
-    m_snake.clear();
-    m_snake.push_back({m_cols / 2, m_rows / 2});
-    m_snake.push_back({m_cols / 2 - 1, m_rows / 2});
-    m_snake.push_back({m_cols / 2 - 2, m_rows / 2});
+    // remember where the random stream starts, so the run can be replayed
+    m_startSeed = m_rng.GetState();
+
+    m_world.Reset();
+    m_reach.MarkDirty();
+    ResetSnake();
+    LoadChunksAroundHead();
     m_dir = Dir::RIGHT;
     m_grow = false;
     m_gameOver = false;
+    m_deathCause = DeathCause::NONE;
     m_paused = false;
     m_score = 0;
     m_level = 1;
-    m_speed = 0.12f;
+    m_speed = TickSecondsForLevel(m_level);
 
     // Generate obstacles for level 1
     GenerateObstaclesForLevel(m_level);
 
-    // Respawn all foods ensuring no overlap with snake, obstacles, and between foods
-    std::vector<Pos> other;
+    // drop level bonus foods of the previous run (they come after the poison)
     for (size_t i = 0; i < m_foods.size(); ++i) {
-        std::vector<Pos> others;
-        for (size_t j = 0; j < m_foods.size(); ++j) {
-            if (i == j) continue;
-            others.push_back(m_foods[j].GetPosition());
+        if (m_foods[i].IsPoison()) {
+            m_foods.erase(m_foods.begin() + i + 1, m_foods.end());
+            break;
         }
-        // Add obstacles to the list of positions to avoid
-        for (const auto& obs : m_obstacles) {
-            others.push_back(obs);
+    }
+
+    // Respawn all foods ensuring no overlap with snake, obstacles, and between foods.
+    // Poison starts hidden and appears after a delay.
+    m_timers.Clear();
+    for (size_t i = 0; i < m_foods.size(); ++i) {
+        if (m_foods[i].IsPoison()) {
+            HideFood(i);
+            m_timers.Schedule(PoisonDelay(), (int)TimerEvent::SPAWN_FOOD, (int)i);
+            continue;
         }
-        m_foods[i].Respawn(m_snake, others);
+        RespawnFood(i);
     }
+    SyncReachability();
+
+    m_hash = ComputeStateHash();
+    Emit(GameEventType::GAME_STARTED);
 }
 
 void Game::StartGame() {
@@ -91,19 +271,131 @@ void Game::SetDirection(Dir d) {
         (d == Dir::RIGHT && m_dir == Dir::LEFT))
         return;
 
+    m_hash ^= Zobrist::Direction((int)m_dir) ^ Zobrist::Direction((int)d);
     m_dir = d;
 }
 
+Dir Game::GetDirection() const {
+    return m_dir;
+}
+
+void Game::SetEventStream(EventStream* stream) {
+    m_events = stream;
+}
+
+EventStream* Game::GetEventStream() const {
+    return m_events;
+}
+
+void Game::CopyStateFrom(const Game& other) {
+    if (this == &other) return;
+    EventStream* events = m_events;
+    std::string file;
+    file.swap(m_highScoreFile);
+    *this = other;
+    m_events = events;
+    m_highScoreFile.swap(file);
+    // assignment sizes vectors to fit; a copy swapped into a game must keep
+    // the reserve that makes its ticks allocation-free
+    ReserveObstacles();
+    // the copied undo goes with the other game's journals
+    m_undo.valid = false;
+}
+
+void Game::SwapState(Game& other) {
+    if (this == &other) return;
+    int best = m_highScore;
+    std::swap(*this, other);
+    std::swap(m_events, other.m_events);
+    m_highScoreFile.swap(other.m_highScoreFile);
+    m_undo.valid = false;
+    other.m_undo.valid = false;
+    if (m_highScore > best) SaveHighScore();
+}
+
+void Game::UpdateUndoable(Dir d) {
+    Undo& u = m_undo;
+    u.dir = m_dir;
+    u.grow = m_grow;
+    u.gameOver = m_gameOver;
+    u.deathCause = m_deathCause;
+    u.deathCell = m_deathCell;
+    u.score = m_score;
+    u.level = m_level;
+    u.speed = m_speed;
+    u.hash = m_hash;
+    u.highScore = m_highScore;
+    u.state = m_state;
+    u.foods = m_foods;
+    u.rng = m_rng;
+    u.timers = m_timers;
+    // the tick adds at most one head and pops from the tail
+    u.snakeSize = m_snake.size();
+    u.tailCount = (int)std::min<size_t>(m_snake.size(), Undo::TAILS);
+    std::copy(m_snake.end() - u.tailCount, m_snake.end(), u.tails);
+    m_world.StartJournal();
+    m_reach.StartJournal();
+
+    m_hash ^= Zobrist::Direction((int)m_dir) ^ Zobrist::Direction((int)d);
+    m_dir = d;
+    Update();
+
+    bool noted = m_world.StopJournal();
+    noted = m_reach.StopJournal() && noted;
+    bool ticked = m_timers.Now() != u.timers.Now();
+    u.headAdded = ticked && !m_gameOver;
+    size_t popped = u.snakeSize + (u.headAdded ? 1 : 0) - m_snake.size();
+    // a new level brings new obstacles, which aren't noted
+    u.valid = noted && m_level == u.level && popped <= (size_t)u.tailCount;
+}
+
+bool Game::UndoUpdate() {
+    Undo& u = m_undo;
+    if (!u.valid) return false;
+    u.valid = false;
+
+    m_world.RollBack();
+    m_reach.RollBack();
+    if (u.headAdded) m_snake.erase(m_snake.begin());
+    size_t popped = u.snakeSize - m_snake.size();
+    m_snake.insert(m_snake.end(), u.tails + u.tailCount - popped, u.tails + u.tailCount);
+
+    m_dir = u.dir;
+    m_grow = u.grow;
+    m_gameOver = u.gameOver;
+    m_deathCause = u.deathCause;
+    m_deathCell = u.deathCell;
+    m_score = u.score;
+    m_level = u.level;
+    m_speed = u.speed;
+    m_hash = u.hash;
+    m_highScore = u.highScore;
+    m_state = u.state;
+    m_foods = u.foods;
+    m_rng = u.rng;
+    m_timers = u.timers;
+    return true;
+}
+
+void Game::Emit(GameEventType type, int a, int b, Pos pos) {
+    if (!m_events) return;
+    m_events->Publish(GameEvent{type, a, b, pos, m_timers.Now()});
+}
+
 void Game::Update() {
     if (m_state != GameState::PLAYING) return;
     if (m_gameOver || m_paused) return;
 
+    // fire timed events due this tick
+    m_timers.Advance([this](int event, int arg) { OnTimer((TimerEvent)event, arg); });
+
     MoveHead();
 
     Pos head = m_snake.front();
 
-    // check each food
+    // check each food (hidden poison can't be eaten)
     for (size_t i = 0; i < m_foods.size(); ++i) {
+        if (!m_foods[i].IsVisible()) continue;
         auto fpos = m_foods[i].GetPosition();
         if (head.x == fpos.x && head.y == fpos.y) {
             int foodValue = m_foods[i].GetValue();
@@ -111,36 +403,146 @@ void Game::Update() {
             if (foodValue < 0) {
                 // Poison food - shrink snake
                 int shrinkAmount = -foodValue / 10; // e.g., -10 value = shrink by 1
-                for (int j = 0; j < shrinkAmount && m_snake.size() > 3; ++j) {
-                    m_snake.pop_back();
+                int lost = 0;
+                for (; lost < shrinkAmount && m_snake.size() > 3; ++lost) {
+                    PopTail();
                 }
+                Emit(GameEventType::POISON_EATEN, lost, (int)i, fpos);
             } else {
                 // Regular food - grow and score
                 m_score += foodValue;
                 m_grow = true;
+                Emit(GameEventType::FOOD_EATEN, foodValue, (int)i, fpos);
+                Emit(GameEventType::SCORE_CHANGED, m_score, foodValue);
             }
             
-            // respawn this food, provide positions of other foods and obstacles so it won't overlap
-            std::vector<Pos> others;
-            for (size_t j = 0; j < m_foods.size(); ++j) {
-                if (i == j) continue;
-                others.push_back(m_foods[j].GetPosition());
-            }
-            // Add obstacles
-            for (const auto& obs : m_obstacles) {
-                others.push_back(obs);
+            // respawn this food away from the snake, other foods and obstacles;
+            // poison goes away for a while instead
+            if (m_foods[i].IsPoison()) {
+                HideFood(i);
+                m_timers.Schedule(PoisonDelay(), (int)TimerEvent::SPAWN_FOOD, (int)i);
+            } else {
+                RespawnFood(i);
             }
-            m_foods[i].Respawn(m_snake, others);
         }
     }
 
     if (!m_grow)
-        m_snake.pop_back();  // move (no grow)
+        PopTail();           // move (no grow)
     else
         m_grow = false;      // reset grow
 
     // after moving / eating, recalc level & speed
     RecalculateLevelAndSpeed();
+
+    // a split the incremental update couldn't settle is rebuilt here, so
+    // queries between ticks are always exact
+    SyncReachability();
+
+    VerifyStateHash();
+}
+
+void Game::LoadChunksAroundHead() {
+    m_world.LoadAround(m_snake.front(), LOAD_RADIUS);
+}
+
+void Game::PopTail() {
+    m_hash ^= Zobrist::SnakeCell(m_snake.back());
+    m_world.ClearFlags(m_snake.back(), CELL_SNAKE);
+    // a level change may have put an obstacle under the body
+    if (!(m_world.Peek(m_snake.back()) & CELL_OBSTACLE)) m_reach.Free(m_snake.back());
+    m_snake.pop_back();
+}
+
+void Game::RespawnFood(size_t i) {
+    m_hash ^= FoodKey(i);
+
+    // visible foods never share a cell, so the old one is simply freed
+    if (m_foods[i].IsVisible())
+        m_world.ClearFlags(m_foods[i].GetPosition(), CELL_FOOD);
+
+    PlaceFood(m_foods[i]);
+    m_world.SetFlags(m_foods[i].GetPosition(), CELL_FOOD);
+
+    m_hash ^= FoodKey(i);
+    Emit(GameEventType::FOOD_SPAWNED, (int)i, 0, m_foods[i].GetPosition());
+}
+
+void Game::HideFood(size_t i) {
+    if (!m_foods[i].IsVisible()) return;
+    m_hash ^= FoodKey(i);
+    m_world.ClearFlags(m_foods[i].GetPosition(), CELL_FOOD);
+    m_foods[i].Hide();
+    m_hash ^= FoodKey(i);
+    Emit(GameEventType::FOOD_HIDDEN, (int)i, 0, m_foods[i].GetPosition());
+}
+
+void Game::PlaceFood(Food& food) {
+    // only where the head can get to
+    SyncReachability();
+    Pos head = m_snake.front();
+    const Reachability* reach = m_reach.IsEnabled() ? &m_reach : nullptr;
+
+    // small boards: anywhere; huge boards: near the head so it can be found
+    if (m_cols <= SPAWN_WINDOW && m_rows <= SPAWN_WINDOW) {
+        food.Respawn(m_world, m_rng, {0, 0}, m_cols, m_rows, reach, head);
+        return;
+    }
+    int w = std::min(m_cols, SPAWN_WINDOW);
+    int h = std::min(m_rows, SPAWN_WINDOW);
+    Pos origin = {(head.x - w / 2 + m_cols) % m_cols, (head.y - h / 2 + m_rows) % m_rows};
+    food.Respawn(m_world, m_rng, origin, w, h, reach, head);
+}
+
+void Game::SyncReachability() {
+    if (m_reach.IsDirty()) m_reach.Rebuild(m_world);
+}
+
+int Game::GetRegionAhead(Dir d) const {
+    Pos p = m_snake.front();
+    switch (d) {
+    case Dir::UP:    p.y = (p.y + m_rows - 1) % m_rows; break;
+    case Dir::DOWN:  p.y = (p.y + 1) % m_rows; break;
+    case Dir::LEFT:  p.x = (p.x + m_cols - 1) % m_cols; break;
+    case Dir::RIGHT: p.x = (p.x + 1) % m_cols; break;
+    }
+    return m_reach.RegionSize(p);
+}
+
+void Game::OnTimer(TimerEvent event, int arg) {
+    switch (event) {
+        case TimerEvent::SPAWN_FOOD:
+            if (arg >= 0 && arg < (int)m_foods.size()) RespawnFood(arg);
+            break;
+    }
+}
+
+uint64_t Game::FoodKey(size_t i) const {
+    const Food& f = m_foods[i];
+    return f.IsVisible() ? Zobrist::Food((int)i, f.GetPosition())
+                         : Zobrist::HiddenFood((int)i);
+}
+
+uint64_t Game::ComputeStateHash() const {
+    uint64_t h = Zobrist::Direction((int)m_dir);
+    if (!m_snake.empty()) h ^= Zobrist::SnakeHead(m_snake.front());
+    for (const auto& p : m_snake) h ^= Zobrist::SnakeCell(p);
+    for (size_t i = 0; i < m_foods.size(); ++i) h ^= FoodKey(i);
+    for (const auto& obs : m_obstacles) h ^= Zobrist::Obstacle(obs);
+    // procedural obstacles are fully determined by the world seed
+    if (m_world.IsProcedural()) h ^= Zobrist::WorldSeed(m_world.GetSeed());
+    return h;
+}
+
+void Game::VerifyStateHash() const {
+#ifdef SNAKE_VERIFY_HASH
+    uint64_t full = ComputeStateHash();
+    if (full != m_hash) {
+        fprintf(stderr, "state hash mismatch: incremental %016llx, full %016llx\n",
+                (unsigned long long)m_hash, (unsigned long long)full);
+        abort();
+    }
+#endif
 }
 
 void Game::Grow() {
@@ -148,23 +550,11 @@ void Game::Grow() {
 }
 
 bool Game::CheckSelfCollision(const Pos& newHead) {
-    for (size_t i = 0; i < m_snake.size(); ++i) {
-        if (m_snake[i].x == newHead.x &&
-            m_snake[i].y == newHead.y)
-        {
-            return true;
-        }
-    }
-    return false;
+    return (m_world.Get(newHead) & CELL_SNAKE) != 0;
 }
 
 bool Game::CheckObstacleCollision(const Pos& pos) {
-    for (const auto& obs : m_obstacles) {
-        if (obs.x == pos.x && obs.y == pos.y) {
-            return true;
-        }
-    }
-    return false;
+    return (m_world.Get(pos) & CELL_OBSTACLE) != 0;
 }
 
 void Game::MoveHead() {
@@ -185,20 +575,40 @@ void Game::MoveHead() {
     else if (newHead.y >= m_rows) newHead.y = 0;
 
     // Check collisions
-    if (CheckSelfCollision(newHead) || CheckObstacleCollision(newHead)) {
+    bool hitSelf = CheckSelfCollision(newHead);
+    if (hitSelf || CheckObstacleCollision(newHead)) {
         m_gameOver = true;
+        m_deathCause = hitSelf ? DeathCause::SELF : DeathCause::OBSTACLE;
+        m_deathCell = newHead;
         m_state = GameState::GAME_OVER;
         // save high score if beaten
         if (m_score > m_highScore) {
+            Emit(GameEventType::NEW_HIGH_SCORE, m_score, m_highScore);
             m_highScore = m_score;
             SaveHighScore();
         }
+        Emit(GameEventType::GAME_OVER, (int)m_deathCause, m_score, newHead);
     } else {
-        m_snake.insert(m_snake.begin(), newHead);
+        m_hash ^= Zobrist::SnakeHead(m_snake.front()) ^
+                  Zobrist::SnakeHead(newHead) ^ Zobrist::SnakeCell(newHead);
+        Pos oldHead = m_snake.front();
+        m_snake.insert(m_snake.begin(), newHead); // capacity reserved, no realloc
+        m_world.SetFlags(newHead, CELL_SNAKE);
+        m_reach.Occupy(newHead);
+
+        // entering a new chunk: load the ones coming into view and let go
+        // of procedural chunks left far behind
+        if ((oldHead.x >> World::CHUNK_BITS) != (newHead.x >> World::CHUNK_BITS) ||
+            (oldHead.y >> World::CHUNK_BITS) != (newHead.y >> World::CHUNK_BITS)) {
+            LoadChunksAroundHead();
+            m_world.EvictFar(newHead, EVICT_RADIUS);
+        }
     }
 }
 
 bool Game::IsGameOver() const { return m_gameOver; }
+DeathCause Game::GetDeathCause() const { return m_deathCause; }
+Pos Game::GetDeathCell() const { return m_deathCell; }
 bool Game::IsPaused() const { return m_paused; }
 void Game::TogglePause() { 
     if (m_state == GameState::PLAYING && !m_gameOver) {
@@ -211,12 +621,21 @@ void Game::TogglePause() {
 }
 int Game::GetScore() const { return m_score; }
 int Game::GetLevel() const { return m_level; }
+float Game::GetSpeed() const { return m_speed; }
 int Game::GetHighScore() const { return m_highScore; }
+int Game::GetCols() const { return m_cols; }
+int Game::GetRows() const { return m_rows; }
+uint64_t Game::GetTick() const { return m_timers.Now(); }
+unsigned char Game::GetCellFlags(Pos p) { return m_world.Get(p); }
+unsigned char Game::PeekCellFlags(Pos p) const { return m_world.Peek(p); }
+const World& Game::GetWorld() const { return m_world; }
 const std::vector<Pos>& Game::GetSnake() const { return m_snake; }
 const std::vector<Food>& Game::GetFoods() const { return m_foods; }
 const std::vector<Pos>& Game::GetObstacles() const { return m_obstacles; }
+uint64_t Game::GetStateHash() const { return m_hash; }
 
 void Game::LoadHighScore() {
+    if (m_highScoreFile.empty()) { m_highScore = 0; return; }
     std::ifstream in(m_highScoreFile);
     if (!in) { m_highScore = 0; return; }
     int v = 0;
@@ -226,69 +645,179 @@ void Game::LoadHighScore() {
 }
 
 void Game::SaveHighScore() {
+    if (m_highScoreFile.empty()) return;
     std::ofstream out(m_highScoreFile, std::ios::trunc);
     if (!out) return;
     out << m_highScore;
 }
 
+bool Game::LoadLevelPack(const std::string& path, std::string* error) {
+    LevelPack pack;
+    if (!pack.Load(path, error)) return false;
+    if (pack.Cols() != m_cols || pack.Rows() != m_rows) {
+        if (error) *error = path + ": pack is for a different board size";
+        return false;
+    }
+    m_levelPack = pack;
+    ReserveObstacles();
+
+    // hot reload: apply the new layout and speed to the running game
+    if (m_state != GameState::MENU) {
+        RefreshObstacles();
+        m_speed = TickSecondsForLevel(m_level);
+    }
+    return true;
+}
+
+void Game::SetDifficulty(const DifficultyConfig& difficulty) {
+    m_difficulty = difficulty;
+
+    // foods before the poison are the initial ones, after it the level bonuses
+    bool pastPoison = false;
+    for (size_t i = 0; i < m_foods.size(); ++i) {
+        if (m_foods[i].IsPoison()) {
+            m_foods[i].SetValue(m_difficulty.poisonValue);
+            pastPoison = true;
+        } else if (pastPoison) {
+            m_foods[i].SetValue(m_difficulty.levelBonusFood);
+        } else {
+            m_foods[i].SetValue(i == 0 ? m_difficulty.foodValue : m_difficulty.bonusFoodValue);
+        }
+    }
+    if (m_state != GameState::MENU) m_speed = TickSecondsForLevel(m_level);
+}
+
+uint64_t Game::GetLevelPackChecksum() const {
+    return m_levelPack.Checksum();
+}
+
+const DifficultyConfig& Game::GetDifficulty() const {
+    return m_difficulty;
+}
+
+int Game::LevelForScore(int score) const {
+    // level pack thresholds first, then every pointsPerLevel -> +1 level
+    const int step = m_difficulty.pointsPerLevel;
+    int packLevels = m_levelPack.LevelCount();
+    if (packLevels == 0) return 1 + (score / step);
+
+    int level = 1;
+    for (int l = 2; l <= packLevels; ++l)
+        if (score >= (int)m_levelPack.Level(l)->scoreThreshold) level = l;
+    int last = (int)m_levelPack.Level(packLevels)->scoreThreshold;
+    if (level == packLevels && score >= last) level += (score - last) / step;
+    return level;
+}
+
+float Game::TickSecondsForLevel(int level) const {
+    if (const LevelPackEntry* e = m_levelPack.Level(level)) return e->tickSeconds;
+
+    // speed reduces a bit with level, clamp to a minimum
+    return m_difficulty.TickSeconds(level);
+}
+
+int Game::BonusFoodForLevel(int level) const {
+    if (const LevelPackEntry* e = m_levelPack.Level(level)) return e->bonusFoodValue;
+    // add a slightly valuable food every few levels (keep it simple)
+    return (level > 1 && (level % m_difficulty.bonusEvery) == 0) ? m_difficulty.levelBonusFood : 0;
+}
+
+uint64_t Game::PoisonDelay() const {
+    if (const LevelPackEntry* e = m_levelPack.Level(m_level)) return e->poisonDelay;
+    return POISON_SPAWN_DELAY;
+}
+
+void Game::RefreshObstacles() {
+    GenerateObstaclesForLevel(m_level);
+
+    // Respawn foods to avoid new obstacles
+    for (size_t i = 0; i < m_foods.size(); ++i) {
+        // Check if current food is on obstacle, respawn if needed
+        if (m_foods[i].IsVisible() && CheckObstacleCollision(m_foods[i].GetPosition())) {
+            RespawnFood(i);
+        }
+    }
+    SyncReachability();
+}
+
 void Game::RecalculateLevelAndSpeed() {
-    // example: every 50 points -> +1 level (max level 5)
-    int newLevel = 1 + (m_score / 50);
-    if (newLevel > 5) newLevel = 5; // cap at level 5
+    int newLevel = LevelForScore(m_score);
     
     if (newLevel != m_level) {
+        Emit(GameEventType::LEVEL_CHANGED, newLevel, m_level);
         m_level = newLevel;
         
         // Generate new obstacles for the new level
-        GenerateObstaclesForLevel(m_level);
-        
-        // Respawn foods to avoid new obstacles
-        for (size_t i = 0; i < m_foods.size(); ++i) {
-            std::vector<Pos> others;
-            for (size_t j = 0; j < m_foods.size(); ++j) {
-                if (i == j) continue;
-                others.push_back(m_foods[j].GetPosition());
-            }
-            for (const auto& obs : m_obstacles) {
-                others.push_back(obs);
-            }
-            // Check if current food is on obstacle, respawn if needed
-            bool onObstacle = false;
-            auto fpos = m_foods[i].GetPosition();
-            for (const auto& obs : m_obstacles) {
-                if (obs.x == fpos.x && obs.y == fpos.y) {
-                    onObstacle = true;
-                    break;
-                }
-            }
-            if (onObstacle) {
-                m_foods[i].Respawn(m_snake, others);
-            }
-        }
+        RefreshObstacles();
         
-        // optional: add a new food every few levels (keep it simple)
-        if (m_level > 1 && (m_level % 3) == 0 && m_foods.size() < 5) {
-            // push a new slightly valuable food
-            m_foods.emplace_back(m_cols, m_rows, 20);
+        int bonusValue = BonusFoodForLevel(m_level);
+        if (bonusValue > 0 && m_foods.size() < MAX_FOODS) {
+            // push a new slightly valuable food (capacity reserved, no realloc)
+            m_foods.emplace_back(m_cols, m_rows, bonusValue);
             // respawn it not on snake, other foods, or obstacles
-            std::vector<Pos> otherPositions;
-            for (size_t i = 0; i + 1 < m_foods.size(); ++i)
-                otherPositions.push_back(m_foods[i].GetPosition());
-            for (const auto& obs : m_obstacles)
-                otherPositions.push_back(obs);
-            m_foods.back().Respawn(m_snake, otherPositions);
+            PlaceFood(m_foods.back());
+            m_world.SetFlags(m_foods.back().GetPosition(), CELL_FOOD);
+            m_hash ^= FoodKey(m_foods.size() - 1);
+            Emit(GameEventType::FOOD_SPAWNED, (int)m_foods.size() - 1, 0, m_foods.back().GetPosition());
         }
     }
 
-    // speed reduces a bit with level, clamp to a minimum
-    float base = 0.12f;
-    float decrease = 0.01f * (m_level - 1); // -0.01 per level
-    m_speed = base - decrease;
-    if (m_speed < 0.03f) m_speed = 0.03f;
+    m_speed = TickSecondsForLevel(m_level);
+}
+
+void Game::PrepareGeneratedLevels() {
+    if (m_generatedLevels || m_world.IsProcedural()) return;
+    m_generatedLevels = GeneratedLevels(m_cols, m_rows);
+    ReserveObstacles();
+}
+
+void Game::BuildGeneratedLevelsFrom(int first) {
+    PrepareGeneratedLevels();
+    if (m_generatedLevels) QueueGeneratedLevels(m_generatedLevels, std::min(first, GENERATED_LEVELS));
+}
+
+void Game::FinishGeneratedLevels() {
+    PrepareGeneratedLevels();
+    if (!m_generatedLevels) return;
+    for (int level = 1; level <= GENERATED_LEVELS; ++level)
+        if (!IsHandCoded(m_cols, m_rows, level)) GeneratedLayout(*m_generatedLevels, level);
+}
+
+void Game::ReserveObstacles() {
+    // room for the largest layout any level can load, so level changes
+    // never reallocate. Generated layouts may still be building, so they
+    // get room for a full board (capped like the snake).
+    size_t most = MAX_HAND_CODED_OBSTACLES;
+    if (m_generatedLevels)
+        most = std::max(most, std::min<size_t>((size_t)m_cols * m_rows, MAX_SNAKE_RESERVE));
+    for (int l = 1; l <= m_levelPack.LevelCount(); ++l)
+        most = std::max<size_t>(most, m_levelPack.Level(l)->obstacleCount);
+    m_obstacles.reserve(most);
+}
+
+Game::LayoutId Game::LayoutForLevel(int level) const {
+    if (m_world.IsProcedural()) return {LayoutSource::PROCEDURAL, 0, 0};
+    // a loaded level pack takes precedence for the levels it defines
+    if (m_levelPack.Level(level)) return {LayoutSource::LEVEL_PACK, level, m_levelPack.Checksum()};
+    // The hand-coded layouts are drawn for 20x20; anything else is generated
+    if (IsHandCoded(m_cols, m_rows, level)) return {LayoutSource::HAND_CODED, level, 0};
+    return {LayoutSource::GENERATED, std::min(level, GENERATED_LEVELS), LEVEL_SEED};
 }
 
 void Game::GenerateObstaclesForLevel(int level) {
+    // obstacles come and go in bulk: rebuild regions on the next query
+    m_reach.MarkDirty();
+
+    for (const auto& obs : m_obstacles) {
+        m_hash ^= Zobrist::Obstacle(obs);
+        m_world.ClearFlags(obs, CELL_OBSTACLE);
+    }
     m_obstacles.clear();
+
+    // procedural worlds generate their own obstacles chunk by chunk
+    const LayoutId id = LayoutForLevel(level);
+    if (id.source == LayoutSource::PROCEDURAL) return;
+    PrepareGeneratedLevels();
     
     // Helper lambda to add obstacle avoiding center spawn area
     auto addObstacle = [&](int x, int y) {
@@ -301,9 +830,28 @@ void Game::GenerateObstaclesForLevel(int level) {
         }
         if (x >= 0 && x < m_cols && y >= 0 && y < m_rows) {
             m_obstacles.push_back({x, y});
+            m_hash ^= Zobrist::Obstacle({x, y});
+            m_world.SetFlags({x, y}, CELL_OBSTACLE);
         }
     };
     
+    // the levels after this one are built while it is played
+    if (id.source == LayoutSource::LEVEL_PACK) {
+        const LevelPackEntry& e = *m_levelPack.Level(level);
+        for (int y = 0; y < m_rows; ++y)
+            for (int x = 0; x < m_cols; ++x)
+                if (m_levelPack.IsObstacle(e, x, y)) addObstacle(x, y);
+        BuildGeneratedLevelsFrom(level + 1);
+        return;
+    }
+    if (id.source == LayoutSource::GENERATED) {
+        const std::vector<Pos>& layout = GeneratedLayout(*m_generatedLevels, id.index);
+        for (const auto& p : layout) addObstacle(p.x, p.y);
+        BuildGeneratedLevelsFrom(id.index + 1);
+        return;
+    }
+    BuildGeneratedLevelsFrom(level + 1);
+
     switch (level) {
         case 1: {
             // Level 1: Simple 2x1 obstacles scattered around
@@ -441,8 +989,6 @@ void Game::GenerateObstaclesForLevel(int level) {
         }
         
         default:
-            // Level 5+ uses level 5 pattern
-            GenerateObstaclesForLevel(5);
             break;
     }
 }
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include "game.h"
+#include <cstring>
+
+// Snapshot payload, native byte order (little endian on all our targets):
+//   int32 cols, rows; uint8 procedural; uint64 world seed
+//   uint8 dir, grow; int32 score, level; uint64 rng state
+//   uint64 tick, start seed                            timer wheel Now(), m_startSeed
+//   uint32 n + n x (int32 x, y)                        snake, head first
+//   uint32 n + n x (int32 value; uint8 poison, visible; int32 x, y)   foods
+//   uint8 source; int32 index; uint64 seed             obstacle layout (LayoutId)
+//   uint32 n + n x (uint64 remaining; int32 event, arg) pending timers
+
+namespace {
+
+// foods and timers in a snapshot are few; anything above this is corrupt
+const uint32_t MAX_SNAPSHOT_FOODS = 64;
+const uint32_t MAX_SNAPSHOT_TIMERS = 1024;
+
+struct Writer {
+    std::vector<unsigned char>& out;
+
+    template <typename T>
+    void Put(T v) {
+        size_t at = out.size();
+        out.resize(at + sizeof(T));
+        memcpy(&out[at], &v, sizeof(T));
+    }
+    void PutPos(Pos p) { Put<int32_t>(p.x); Put<int32_t>(p.y); }
+};
+
+struct Reader {
+    const unsigned char* data;
+    size_t size;
+    size_t at;
+
+    template <typename T>
+    bool Get(T& v) {
+        if (size - at < sizeof(T)) return false;
+        memcpy(&v, data + at, sizeof(T));
+        at += sizeof(T);
+        return true;
+    }
+    bool GetPos(Pos& p, int cols, int rows) {
+        int32_t x, y;
+        if (!Get(x) || !Get(y)) return false;
+        p = {x, y};
+        return x >= 0 && x < cols && y >= 0 && y < rows;
+    }
+    // a count whose entries (entrySize bytes each) fit in the rest
+    bool GetCount(uint32_t& n, size_t entrySize) {
+        return Get(n) && n <= (size - at) / entrySize;
+    }
+};
+
+struct SavedFood {
+    int32_t value;
+    uint8_t poison, visible;
+    Pos pos;
+};
+
+struct SavedTimer {
+    uint64_t remaining;
+    int32_t event, arg;
+};
+
+} // namespace
+
+void Game::SaveSnapshot(std::vector<unsigned char>& out) const {
+    out.clear();
+    Writer w{out};
+    w.Put<int32_t>(m_cols);
+    w.Put<int32_t>(m_rows);
+    w.Put<uint8_t>(m_world.IsProcedural() ? 1 : 0);
+    w.Put<uint64_t>(m_world.GetSeed());
+
+    w.Put<uint8_t>((uint8_t)m_dir);
+    w.Put<uint8_t>(m_grow ? 1 : 0);
+    w.Put<int32_t>(m_score);
+    w.Put<int32_t>(m_level);
+    w.Put<uint64_t>(m_rng.GetState());
+    w.Put<uint64_t>(m_timers.Now());
+    w.Put<uint64_t>(m_startSeed);
+
+    w.Put<uint32_t>((uint32_t)m_snake.size());
+    for (const auto& p : m_snake) w.PutPos(p);
+
+    w.Put<uint32_t>((uint32_t)m_foods.size());
+    for (const auto& f : m_foods) {
+        w.Put<int32_t>(f.GetValue());
+        w.Put<uint8_t>(f.IsPoison() ? 1 : 0);
+        w.Put<uint8_t>(f.IsVisible() ? 1 : 0);
+        w.PutPos(f.GetPosition());
+    }
+
+    // the layout is rebuilt from where it came from, which keeps the blob
+    // small on large boards
+    const LayoutId layout = LayoutForLevel(m_level);
+    w.Put<uint8_t>((uint8_t)layout.source);
+    w.Put<int32_t>(layout.index);
+    w.Put<uint64_t>(layout.seed);
+
+    w.Put<uint32_t>((uint32_t)m_timers.Pending());
+    m_timers.ForEach([&](uint64_t remaining, int event, int arg) {
+        w.Put<uint64_t>(remaining);
+        w.Put<int32_t>(event);
+        w.Put<int32_t>(arg);
+    });
+}
+
+bool Game::LoadSnapshot(const unsigned char* data, size_t size, std::string* error) {
+    auto fail = [&](const char* why) {
+        if (error) *error = why;
+        return false;
+    };
+
+    Reader r{data, size, 0};
+    int32_t cols, rows, score, level;
+    uint8_t procedural, dir, grow;
+    uint64_t seed, rngState, tick, startSeed;
+    if (!r.Get(cols) || !r.Get(rows) || !r.Get(procedural) || !r.Get(seed))
+        return fail("truncated snapshot");
+    if (cols != m_cols || rows != m_rows) return fail("snapshot is for a different board size");
+    if ((procedural != 0) != m_world.IsProcedural() || (procedural && seed != m_world.GetSeed()))
+        return fail("snapshot is for a different world");
+
+    if (!r.Get(dir) || !r.Get(grow) || !r.Get(score) || !r.Get(level) || !r.Get(rngState) ||
+        !r.Get(tick) || !r.Get(startSeed))
+        return fail("truncated snapshot");
+    if (dir > (uint8_t)Dir::RIGHT || level < 1) return fail("bad snapshot header");
+
+    // read and check everything before changing the game
+    uint32_t n;
+    std::vector<Pos> snake;
+    if (!r.GetCount(n, 8) || n == 0) return fail("bad snake");
+    snake.resize(n);
+    for (auto& p : snake)
+        if (!r.GetPos(p, m_cols, m_rows)) return fail("bad snake");
+
+    std::vector<SavedFood> foods;
+    if (!r.GetCount(n, 14) || n > MAX_SNAPSHOT_FOODS) return fail("bad foods");
+    foods.resize(n);
+    for (auto& f : foods)
+        if (!r.Get(f.value) || !r.Get(f.poison) || !r.Get(f.visible) || !r.GetPos(f.pos, m_cols, m_rows))
+            return fail("bad foods");
+
+    uint8_t source;
+    int32_t index;
+    uint64_t layoutSeed;
+    if (!r.Get(source) || !r.Get(index) || !r.Get(layoutSeed)) return fail("truncated snapshot");
+    const LayoutId layout = LayoutForLevel(level);
+    if (source != (uint8_t)layout.source || index != layout.index || layoutSeed != layout.seed) {
+        bool pack = source == (uint8_t)LayoutSource::LEVEL_PACK || layout.source == LayoutSource::LEVEL_PACK;
+        return fail(pack ? "snapshot is for a different level pack" : "snapshot is for other level layouts");
+    }
+
+    std::vector<SavedTimer> timers;
+    if (!r.GetCount(n, 16) || n > MAX_SNAPSHOT_TIMERS) return fail("bad timers");
+    timers.resize(n);
+    for (auto& t : timers)
+        if (!r.Get(t.remaining) || !r.Get(t.event) || !r.Get(t.arg)) return fail("bad timers");
+    if (r.at != size) return fail("trailing bytes in snapshot");
+
+    // rebuild the world: dynamic flags go, the level's layout replaces ours
+    // (a generated one is normally finished already, see PrefetchSnapshot)
+    m_world.Reset();
+    GenerateObstaclesForLevel(level);
+
+    m_snake = snake;
+    for (const auto& p : m_snake) m_world.SetFlags(p, CELL_SNAKE);
+    LoadChunksAroundHead();
+    m_reach.MarkDirty();
+    SyncReachability();
+
+    m_foods.clear();
+    for (const auto& f : foods) {
+        m_foods.emplace_back(m_cols, m_rows, f.value, f.poison != 0);
+        m_foods.back().Restore(f.pos, f.visible != 0);
+        if (f.visible) m_world.SetFlags(f.pos, CELL_FOOD);
+    }
+
+    // pending timers are saved relative to the tick, so they fire on the
+    // same ticks as in the saved run
+    m_timers.Reset(tick);
+    for (const auto& t : timers) m_timers.Schedule(t.remaining, t.event, t.arg);
+
+    m_dir = (Dir)dir;
+    m_grow = grow != 0;
+    m_score = score;
+    m_level = level;
+    m_speed = TickSecondsForLevel(m_level);
+    m_rng.Seed(rngState);
+    m_startSeed = startSeed;
+    m_gameOver = false;
+    m_deathCause = DeathCause::NONE;
+    m_paused = true;
+    m_state = GameState::PAUSED;
+
+    m_hash = ComputeStateHash();
+    Emit(GameEventType::GAME_STARTED, 1);
+    return true;
+}
+
+void Game::PrefetchSnapshot(const unsigned char* data, size_t size) {
+    Reader r{data, size, 0};
+    int32_t cols, rows, score, level;
+    uint8_t procedural, dir, grow;
+    uint64_t seed;
+    if (!r.Get(cols) || !r.Get(rows) || !r.Get(procedural) || !r.Get(seed) || !r.Get(dir) ||
+        !r.Get(grow) || !r.Get(score) || !r.Get(level))
+        return;
+    // LoadSnapshot would refuse it anyway
+    if (cols != m_cols || rows != m_rows || procedural || level < 1) return;
+    BuildGeneratedLevelsFrom(level);
+}
@@ -6,6 +6,13 @@ bool InputHandler::IsMouseOverRect(int x, int y, int width, int height) {
             mouse.y >= y && mouse.y <= y + height);
 }
 
+float InputHandler::GetZoomDelta() {
+    float delta = GetMouseWheelMove();
+    if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD))      delta += 1.0f;
+    if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) delta -= 1.0f;
+    return delta;
+}
+
 // Processes input based on current game state
 void InputHandler::Process(Game& game) {
     GameState state = game.GetState();
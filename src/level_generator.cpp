@@ -0,0 +1,143 @@
+#include "level_generator.h"
+#include "thread_pool.h"
+#include "rng.h"
+#include <cmath>
+
+// candidates per level; fixed so layouts don't depend on the machine
+static const int CANDIDATES = 8;
+
+namespace {
+
+struct Candidate {
+    std::vector<unsigned char> blocked;
+    float difficulty;
+};
+
+// Walls and L-shapes until the target density is reached, then seal
+// whatever the flood fill from the spawn area can't reach.
+void BuildCandidate(Candidate& c, int cols, int rows, int level, uint64_t seed,
+                    Pos clearMin, Pos clearMax)
+{
+    const size_t cells = (size_t)cols * rows;
+    c.blocked.assign(cells, 0);
+
+    auto inClear = [&](int x, int y) {
+        return x >= clearMin.x && x <= clearMax.x && y >= clearMin.y && y <= clearMax.y;
+    };
+
+    float density = 0.03f + 0.015f * (level - 1);
+    if (density > 0.22f) density = 0.22f;
+    size_t target = (size_t)(cells * density);
+    int maxLength = 3 + level;
+    if (maxLength > cols / 2) maxLength = cols / 2 > 2 ? cols / 2 : 2;
+
+    Rng rng(seed);
+    size_t placed = 0;
+    size_t attempts = 0;
+    while (placed < target && attempts++ < target * 4 + 64) {
+        uint64_t r = rng.Next();
+        int x = (int)(r % (uint64_t)cols);
+        int y = (int)((r >> 20) % (uint64_t)rows);
+        int length = 2 + (int)((r >> 40) % (uint64_t)(maxLength - 1));
+        int shape = (int)((r >> 56) & 3); // 0/1 straight, 2/3 L-shape
+        bool horizontal = (shape & 1) != 0;
+
+        for (int k = 0; k < length; ++k) {
+            int px = horizontal ? x + k : x;
+            int py = horizontal ? y : y + k;
+            // L-shapes turn halfway
+            if (shape >= 2 && k >= length / 2) {
+                px = horizontal ? x + length / 2 : x + (k - length / 2);
+                py = horizontal ? y + (k - length / 2) : y + length / 2;
+            }
+            px %= cols;
+            py %= rows;
+            if (inClear(px, py)) continue;
+            unsigned char& cell = c.blocked[(size_t)py * cols + px];
+            if (!cell) { cell = 1; placed++; }
+        }
+    }
+
+    // flood fill from the spawn center over the wrapping board,
+    // marking reached cells 2; whatever stays 0 is a sealed pocket
+    std::vector<int> stack;
+    stack.reserve(cells / 4);
+    int sx = (clearMin.x + clearMax.x) / 2;
+    int sy = (clearMin.y + clearMax.y) / 2;
+    stack.push_back(sy * cols + sx);
+    c.blocked[stack.back()] = 2;
+    while (!stack.empty()) {
+        int idx = stack.back();
+        stack.pop_back();
+        int y = idx / cols;
+        int x = idx - y * cols;
+        int row = y * cols;
+        int next[4] = {
+            row + (x == cols - 1 ? 0 : x + 1),
+            row + (x == 0 ? cols - 1 : x - 1),
+            (y == rows - 1 ? 0 : row + cols) + x,
+            (y == 0 ? (rows - 1) * cols : row - cols) + x
+        };
+        for (int n : next) {
+            if (c.blocked[n]) continue;
+            c.blocked[n] = 2;
+            stack.push_back(n);
+        }
+    }
+    for (auto& cell : c.blocked) cell = (cell != 2);
+
+    c.difficulty = LevelGenerator::MeasureDifficulty(c.blocked, cols, rows);
+}
+
+} // namespace
+
+float LevelGenerator::TargetDifficulty(int level) {
+    float t = 0.06f + 0.04f * (level - 1);
+    return t > 0.6f ? 0.6f : t;
+}
+
+float LevelGenerator::MeasureDifficulty(const std::vector<unsigned char>& blocked, int cols, int rows) {
+    size_t obstacles = 0, freeCells = 0, narrow = 0, deadEnds = 0;
+    for (int y = 0; y < rows; ++y) {
+        const unsigned char* row = &blocked[(size_t)y * cols];
+        const unsigned char* up = &blocked[(size_t)(y == 0 ? rows - 1 : y - 1) * cols];
+        const unsigned char* down = &blocked[(size_t)(y == rows - 1 ? 0 : y + 1) * cols];
+        for (int x = 0; x < cols; ++x) {
+            if (row[x]) { obstacles++; continue; }
+            freeCells++;
+            int walls = row[x == cols - 1 ? 0 : x + 1] + row[x == 0 ? cols - 1 : x - 1] +
+                        up[x] + down[x];
+            narrow += walls >= 2;
+            deadEnds += walls >= 3;
+        }
+    }
+    if (freeCells == 0) return 1.0f;
+    float total = (float)(obstacles + freeCells);
+    return obstacles / total + 0.5f * narrow / freeCells + 2.0f * deadEnds / freeCells;
+}
+
+std::vector<Pos> LevelGenerator::Generate(int cols, int rows, int level, uint64_t seed,
+                                          Pos clearMin, Pos clearMax)
+{
+    std::vector<Candidate> candidates(CANDIDATES);
+    ThreadPool::Shared().ParallelFor(CANDIDATES, [&](size_t i) {
+        uint64_t s = seed ^ ((uint64_t)level << 32) ^ (i * 0xD1342543DE82EF95ull);
+        BuildCandidate(candidates[i], cols, rows, level, s, clearMin, clearMax);
+    });
+
+    // closest to the target wins; ties go to the lower index
+    float target = TargetDifficulty(level);
+    size_t best = 0;
+    for (size_t i = 1; i < candidates.size(); ++i) {
+        if (std::fabs(candidates[i].difficulty - target) <
+            std::fabs(candidates[best].difficulty - target))
+            best = i;
+    }
+
+    std::vector<Pos> obstacles;
+    const auto& blocked = candidates[best].blocked;
+    for (int y = 0; y < rows; ++y)
+        for (int x = 0; x < cols; ++x)
+            if (blocked[(size_t)y * cols + x]) obstacles.push_back({x, y});
+    return obstacles;
+}
@@ -0,0 +1,284 @@
+#include "level_pack.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+// Read-only mapping of a whole file, unmapped when the last user lets go
+struct LevelPack::MappedFile {
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (data) munmap((void*)data, size);
+#endif
+    }
+
+    bool Open(const std::string& path) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                           nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER len;
+        if (!GetFileSizeEx(file, &len) || len.QuadPart == 0) return false;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return false;
+        data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        size = (size_t)len.QuadPart;
+        return data != nullptr;
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return false; }
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd); // the mapping keeps the file alive
+        if (p == MAP_FAILED) return false;
+        data = (const unsigned char*)p;
+        size = (size_t)st.st_size;
+        return true;
+#endif
+    }
+};
+
+static size_t BitmapBytes(uint32_t cols, uint32_t rows) {
+    return ((size_t)cols * rows + 7) / 8;
+}
+
+LevelPack::LevelPack()
+    : m_header(nullptr),
+      m_entries(nullptr),
+      m_checksum(0)
+{
+}
+
+bool LevelPack::Load(const std::string& path, std::string* error) {
+    auto fail = [&](const char* why) {
+        if (error) *error = path + ": " + why;
+        return false;
+    };
+
+    auto file = std::make_shared<MappedFile>();
+    if (!file->Open(path)) return fail("cannot map file");
+
+    // validate the layout once; afterwards everything is read in place
+    if (file->size < sizeof(LevelPackHeader)) return fail("truncated header");
+    const LevelPackHeader* header = (const LevelPackHeader*)file->data;
+    if (memcmp(header->magic, LEVEL_PACK_MAGIC, sizeof(header->magic)) != 0)
+        return fail("not a level pack");
+    if (header->version != LEVEL_PACK_VERSION) return fail("unsupported version");
+    if (header->fileSize != file->size) return fail("size mismatch");
+    if (header->levelCount == 0 || header->cols == 0 || header->rows == 0)
+        return fail("empty pack");
+
+    size_t tableEnd = sizeof(LevelPackHeader) + (size_t)header->levelCount * sizeof(LevelPackEntry);
+    if (tableEnd > file->size) return fail("truncated level table");
+    const LevelPackEntry* entries = (const LevelPackEntry*)(file->data + sizeof(LevelPackHeader));
+    size_t bitmap = BitmapBytes(header->cols, header->rows);
+    for (uint32_t i = 0; i < header->levelCount; ++i) {
+        if (entries[i].bitmapOffset < tableEnd ||
+            entries[i].bitmapOffset + bitmap > file->size)
+            return fail("bitmap out of range");
+    }
+
+    uint64_t checksum = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < file->size; ++i) {
+        checksum ^= file->data[i];
+        checksum *= 0x100000001B3ull;
+    }
+
+    m_file = file;
+    m_header = header;
+    m_entries = entries;
+    m_checksum = checksum;
+    return true;
+}
+
+void LevelPack::Unload() {
+    m_file.reset();
+    m_header = nullptr;
+    m_entries = nullptr;
+    m_checksum = 0;
+}
+
+bool LevelPack::IsLoaded() const { return m_header != nullptr; }
+int LevelPack::LevelCount() const { return m_header ? (int)m_header->levelCount : 0; }
+int LevelPack::Cols() const { return m_header ? (int)m_header->cols : 0; }
+int LevelPack::Rows() const { return m_header ? (int)m_header->rows : 0; }
+uint64_t LevelPack::Checksum() const { return m_checksum; }
+
+const LevelPackEntry* LevelPack::Level(int level) const {
+    if (!m_header || level < 1 || level > (int)m_header->levelCount) return nullptr;
+    return &m_entries[level - 1];
+}
+
+bool LevelPack::IsObstacle(const LevelPackEntry& entry, int x, int y) const {
+    size_t bit = (size_t)y * m_header->cols + x;
+    const unsigned char* bits = m_file->data + entry.bitmapOffset;
+    return (bits[bit >> 3] >> (bit & 7)) & 1;
+}
+
+bool LevelPack::Compile(const std::string& sourcePath, const std::string& packPath,
+                        std::string& error)
+{
+    std::ifstream in(sourcePath);
+    if (!in) { error = sourcePath + ": cannot open"; return false; }
+
+    struct SourceLevel {
+        LevelPackEntry entry;
+        std::vector<unsigned char> bits;
+    };
+    std::vector<SourceLevel> levels;
+    uint32_t cols = 0, rows = 0;
+
+    std::string line;
+    int lineNo = 0;
+    auto fail = [&](const std::string& why) {
+        error = sourcePath + ":" + std::to_string(lineNo) + ": " + why;
+        return false;
+    };
+
+    while (std::getline(in, line)) {
+        lineNo++;
+        std::istringstream ls(line);
+        std::string key;
+        if (!(ls >> key) || key[0] == '#') continue;
+
+        if (key == "board") {
+            if (!(ls >> cols >> rows) || cols == 0 || rows == 0) return fail("bad board size");
+        } else if (key == "level") {
+            if (cols == 0) return fail("'board' must come before the first level");
+            SourceLevel lvl;
+            lvl.entry = LevelPackEntry{ 0, 0.12f, 0, 100, 0, 0 };
+            lvl.bits.assign(BitmapBytes(cols, rows), 0);
+            levels.push_back(lvl);
+        } else if (levels.empty()) {
+            return fail("'" + key + "' outside a level");
+        } else if (key == "threshold") {
+            if (!(ls >> levels.back().entry.scoreThreshold)) return fail("bad threshold");
+        } else if (key == "tick") {
+            if (!(ls >> levels.back().entry.tickSeconds) || levels.back().entry.tickSeconds <= 0)
+                return fail("bad tick");
+        } else if (key == "bonus_food") {
+            if (!(ls >> levels.back().entry.bonusFoodValue)) return fail("bad bonus_food");
+        } else if (key == "poison_delay") {
+            if (!(ls >> levels.back().entry.poisonDelay)) return fail("bad poison_delay");
+        } else if (key == "map") {
+            SourceLevel& lvl = levels.back();
+            for (uint32_t y = 0; y < rows; ++y) {
+                lineNo++;
+                if (!std::getline(in, line) || line.size() < cols) return fail("map row too short");
+                for (uint32_t x = 0; x < cols; ++x) {
+                    if (line[x] == '#') {
+                        size_t bit = (size_t)y * cols + x;
+                        lvl.bits[bit >> 3] |= (unsigned char)(1u << (bit & 7));
+                        lvl.entry.obstacleCount++;
+                    } else if (line[x] != '.') {
+                        return fail("map cells must be '#' or '.'");
+                    }
+                }
+            }
+        } else {
+            return fail("unknown key '" + key + "'");
+        }
+    }
+    if (levels.empty()) { error = sourcePath + ": no levels"; return false; }
+
+    LevelPackHeader header;
+    memcpy(header.magic, LEVEL_PACK_MAGIC, sizeof(header.magic));
+    header.version = LEVEL_PACK_VERSION;
+    header.levelCount = (uint32_t)levels.size();
+    header.cols = cols;
+    header.rows = rows;
+    header.reserved = 0;
+
+    size_t offset = sizeof(header) + levels.size() * sizeof(LevelPackEntry);
+    for (auto& lvl : levels) {
+        lvl.entry.bitmapOffset = (uint32_t)offset;
+        offset += lvl.bits.size();
+    }
+    header.fileSize = (uint32_t)offset;
+
+    // write to a temporary name and rename, so a running game never maps a
+    // half-written pack
+    std::string tmpPath = packPath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) { error = tmpPath + ": cannot write"; return false; }
+        out.write((const char*)&header, sizeof(header));
+        for (const auto& lvl : levels) out.write((const char*)&lvl.entry, sizeof(lvl.entry));
+        for (const auto& lvl : levels) out.write((const char*)lvl.bits.data(), lvl.bits.size());
+        if (!out) { error = tmpPath + ": write failed"; return false; }
+    }
+#ifdef _WIN32
+    std::remove(packPath.c_str()); // rename doesn't replace on Windows
+#endif
+    if (std::rename(tmpPath.c_str(), packPath.c_str()) != 0) {
+        error = packPath + ": cannot replace";
+        return false;
+    }
+    return true;
+}
+
+LevelPackWatcher::LevelPackWatcher(const std::string& path)
+    : m_fd(-1)
+{
+    // watch the directory: the compiler replaces the pack by renaming
+    size_t slash = path.find_last_of("/\\");
+    m_dir = slash == std::string::npos ? "." : path.substr(0, slash);
+    m_name = slash == std::string::npos ? path : path.substr(slash + 1);
+#ifdef __linux__
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd >= 0 && inotify_add_watch(m_fd, m_dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+#endif
+}
+
+LevelPackWatcher::~LevelPackWatcher() {
+#ifdef __linux__
+    if (m_fd >= 0) close(m_fd);
+#endif
+}
+
+bool LevelPackWatcher::Changed() {
+    bool changed = false;
+#ifdef __linux__
+    if (m_fd < 0) return false;
+    alignas(struct inotify_event) char buf[4096];
+    ssize_t len;
+    while ((len = read(m_fd, buf, sizeof(buf))) > 0) {
+        for (char* p = buf; p < buf + len; ) {
+            const struct inotify_event* ev = (const struct inotify_event*)p;
+            if (ev->len > 0 && m_name == ev->name) changed = true;
+            p += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+#endif
+    return changed;
+}
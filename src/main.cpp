@@ -2,18 +2,36 @@
 #include <vector>
 #include <cstdlib>
 #include <ctime>
+#include <cmath>
 #include <string>
 #include "raylib.h"
 
 #include "game.h"
 #include "input.h"
+#include "session.h"
+#include "replay.h"
+#include "speculator.h"
 
 // Simple grid settings
 const int CELL = 24;
-const int COLS = 20;
+const int COLS = 20;  // default board; override with: snake <cols> <rows> [seed]
 const int ROWS = 20;
-const int WIDTH = COLS * CELL;
+const int WIDTH = COLS * CELL;       // the window always shows a COLS x ROWS viewport
 const int HEIGHT = ROWS * CELL + 80; // extra for HUD
+const int VIEW_HEIGHT = ROWS * CELL; // play area above the HUD
+
+// Camera zoom range; below OVERVIEW_CELL_PIXELS pixels per cell the board is
+// drawn from a downsampled occupancy texture instead of per-cell shapes
+const float MIN_ZOOM = 0.01f;
+const float MAX_ZOOM = 4.0f;
+const float ZOOM_STEP = 1.25f;
+const float OVERVIEW_CELL_PIXELS = 4.0f;
+const int OVERVIEW_TEXEL = 2; // screen pixels per overview texel
+
+const char* LEVEL_PACK_FILE = "levels.pak";
+const char* DIFFICULTY_FILE = "difficulty.cfg";
+const char* SESSION_FILE = "session.sav";
+const char* REPLAY_FILE = "last.replay";  // tools/render_replay turns it into video
 
 // Button dimensions
 const int BUTTON_WIDTH = 200;
@@ -28,12 +46,62 @@ const Color MENU_BG_COLOR = { 240, 248, 255, 255 };      // Alice blue
 
 static double lastUpdate = 0.0;
 
+// actual board size (may be far larger than the viewport)
+static int boardCols = COLS;
+static int boardRows = ROWS;
+
+static Camera2D camera = { { WIDTH / 2.0f, VIEW_HEIGHT / 2.0f }, { 0.0f, 0.0f }, 0.0f, 1.0f };
+
+// set by the game's NEW_HIGH_SCORE event, cleared when a run starts
+static bool newHighScore = false;
+
+// dead-end warning in the HUD, toggled with H
+static bool showDangerHint = true;
+
+// inputs of the run in progress; resumed sessions are not recorded
+static Replay replay;
+static bool recording = false;
+
+// zoomed-out board texture and the board size it was made for
+static Texture2D overviewTexture = {};
+static std::vector<Color> overviewPixels;
+static int overviewCols = 0, overviewRows = 0;
+
 bool EventTriggered(double interval) {
     double t = GetTime();
     if (t - lastUpdate >= interval) { lastUpdate = t; return true; }
     return false;
 }
 
+// Apply the game events published since the last frame to the front end
+void ProcessGameEvents(EventReader& reader, SessionStore& session, const Game& game) {
+    GameEvent e;
+    while (reader.Next(e)) {
+        switch (e.type) {
+            case GameEventType::GAME_STARTED:
+                newHighScore = false;
+                recording = e.a == 0;
+                if (recording) replay.Begin(game);
+                break;
+            case GameEventType::NEW_HIGH_SCORE:
+                newHighScore = true;
+                break;
+            case GameEventType::GAME_OVER:
+                // a finished run has nothing to resume
+                session.Remove();
+                if (recording) {
+                    std::string error;
+                    if (!replay.Save(REPLAY_FILE, error))
+                        TraceLog(LOG_WARNING, "replay not saved: %s", error.c_str());
+                    recording = false;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
 // Draw a button and return true if clicked
 bool DrawButton(const char* text, int x, int y, int width, int height) {
     Vector2 mouse = GetMousePosition();
@@ -61,7 +129,8 @@ bool DrawButton(const char* text, int x, int y, int width, int height) {
     return hover && IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
 }
 
-void DrawMenu(Game& game) {
+// returns true when EXIT was clicked
+bool DrawMenu(Game& game, SessionStore& session) {
     ClearBackground(MENU_BG_COLOR);
     
     // Draw decorative snake pattern in background
@@ -88,93 +157,219 @@ void DrawMenu(Game& game) {
     int hsWidth = MeasureText(highScoreText, 18);
     DrawText(highScoreText, (WIDTH - hsWidth) / 2, 210, 18, GOLD);
     
-    // Buttons
+    // Buttons (CONTINUE only when a saved session exists)
     int buttonX = (WIDTH - BUTTON_WIDTH) / 2;
     int startY = 270;
-    int exitY = 340;
+
+    if (session.HasSession()) {
+        if (DrawButton("CONTINUE", buttonX, startY, BUTTON_WIDTH, BUTTON_HEIGHT)) {
+            std::string error;
+            if (!session.Load(game, &error)) {
+                TraceLog(LOG_WARNING, "cannot continue: %s", error.c_str());
+                session.Remove();
+            }
+        }
+        startY += 70;
+    }
+    int exitY = startY + 70;
     
     if (DrawButton("START GAME", buttonX, startY, BUTTON_WIDTH, BUTTON_HEIGHT)) {
         game.StartGame();
     }
     
-    if (DrawButton("EXIT", buttonX, exitY, BUTTON_WIDTH, BUTTON_HEIGHT)) {
-        CloseWindow();
-        exit(0);
-    }
+    bool exitClicked = DrawButton("EXIT", buttonX, exitY, BUTTON_WIDTH, BUTTON_HEIGHT);
     
     // Instructions
     DrawText("Controls:", 20, HEIGHT - 70, 16, DARKGRAY);
     DrawText("WASD / Arrows: Move | P: Pause | R: Restart", 20, HEIGHT - 50, 14, GRAY);
     DrawText("Press ENTER to start", (WIDTH - MeasureText("Press ENTER to start", 14)) / 2, HEIGHT - 25, 14, DARKGRAY);
+    return exitClicked;
 }
 
-void DrawGame(Game& game) {
-    ClearBackground(RAYWHITE);
+// Map v onto the copy of its wrapped coordinate that is >= lo
+static int WrapFrom(int v, int lo, int size) {
+    return lo + ((v - lo) % size + size) % size;
+}
 
-    // subtle grid
-    for (int x = 0; x < COLS; ++x) {
-        for (int y = 0; y < ROWS; ++y) {
-            DrawRectangle(x*CELL, y*CELL, CELL, CELL, Fade(LIGHTGRAY, 0.08f));
+// Zoom from input, then follow the snake head (or center the board if it fits)
+void UpdateGameCamera(Game& game) {
+    float steps = InputHandler::GetZoomDelta();
+    if (steps != 0.0f) {
+        camera.zoom *= powf(ZOOM_STEP, steps);
+        if (camera.zoom < MIN_ZOOM) camera.zoom = MIN_ZOOM;
+        if (camera.zoom > MAX_ZOOM) camera.zoom = MAX_ZOOM;
+    }
+
+    float cellPx = CELL * camera.zoom;
+    if (boardCols * cellPx <= WIDTH && boardRows * cellPx <= VIEW_HEIGHT) {
+        camera.target = { boardCols * CELL / 2.0f, boardRows * CELL / 2.0f };
+    } else {
+        const Pos& head = game.GetSnake().front();
+        camera.target = { head.x * CELL + CELL / 2.0f, head.y * CELL + CELL / 2.0f };
+    }
+}
+
+// Zoomed far out: sample one cell per texel into a screen-sized texture.
+// Uses PeekCellFlags so unexplored procedural chunks are not generated.
+// Free the overview texture (at shutdown, or when the board size changes)
+void ReleaseOverview() {
+    if (overviewTexture.id != 0) UnloadTexture(overviewTexture);
+    overviewTexture = {};
+    overviewPixels.clear();
+    overviewPixels.shrink_to_fit();
+}
+
+void DrawOverview(Game& game, Vector2 topLeft, bool fits) {
+    std::vector<Color>& pixels = overviewPixels;
+    Texture2D& texture = overviewTexture;
+    const int texW = WIDTH / OVERVIEW_TEXEL;
+    const int texH = VIEW_HEIGHT / OVERVIEW_TEXEL;
+    if (texture.id != 0 && (overviewCols != boardCols || overviewRows != boardRows))
+        ReleaseOverview();
+    if (texture.id == 0) {
+        Image img = GenImageColor(texW, texH, BLANK);
+        texture = LoadTextureFromImage(img);
+        UnloadImage(img);
+        pixels.resize((size_t)texW * texH);
+        overviewCols = boardCols;
+        overviewRows = boardRows;
+    }
+
+    float cellsPerTexel = OVERVIEW_TEXEL / (CELL * camera.zoom);
+    float originX = topLeft.x / CELL;
+    float originY = topLeft.y / CELL;
+    const Color background = { 235, 235, 235, 255 };
+    for (int j = 0; j < texH; ++j) {
+        int y = (int)floorf(originY + (j + 0.5f) * cellsPerTexel);
+        bool rowInside = !fits || (y >= 0 && y < boardRows);
+        int wy = WrapFrom(y, 0, boardRows);
+        for (int i = 0; i < texW; ++i) {
+            int x = (int)floorf(originX + (i + 0.5f) * cellsPerTexel);
+            Color& c = pixels[(size_t)j * texW + i];
+            if (!rowInside || (fits && (x < 0 || x >= boardCols))) { c = RAYWHITE; continue; }
+
+            unsigned char flags = game.PeekCellFlags({ WrapFrom(x, 0, boardCols), wy });
+            if (flags & CELL_SNAKE)         c = SKYBLUE;
+            else if (flags & CELL_OBSTACLE) c = DARKGRAY;
+            else if (flags & CELL_FOOD)     c = RED;
+            else                            c = background;
         }
     }
+    UpdateTexture(texture, pixels.data());
+    DrawTexturePro(texture, { 0, 0, (float)texW, (float)texH },
+                   { 0, 0, (float)(texW * OVERVIEW_TEXEL), (float)(texH * OVERVIEW_TEXEL) },
+                   { 0, 0 }, 0.0f, WHITE);
+
+    // keep the head visible even when it is smaller than a texel
+    const Pos& head = game.GetSnake().front();
+    Vector2 hp = GetWorldToScreen2D({ (float)WrapFrom(head.x, (int)floorf(originX), boardCols) * CELL,
+                                      (float)WrapFrom(head.y, (int)floorf(originY), boardRows) * CELL },
+                                    camera);
+    DrawCircle((int)hp.x, (int)hp.y, 3, BLUE);
+}
+
+// Draw cells [x0..x1] x [y0..y1] in world space (inside BeginMode2D).
+// Read-only: the tick has already loaded the chunks around the head.
+void DrawBoard(const Game& game, int x0, int x1, int y0, int y1) {
+    // subtle grid (the per-cell tint tiles into one rectangle)
+    DrawRectangle(x0*CELL, y0*CELL, (x1 - x0 + 1)*CELL, (y1 - y0 + 1)*CELL, Fade(LIGHTGRAY, 0.08f));
 
-    // draw obstacles (dark gray/black)
-    const auto& obstacles = game.GetObstacles();
-    for (const auto& obs : obstacles) {
-        DrawRectangle(obs.x*CELL, obs.y*CELL, CELL, CELL, DARKGRAY);
-        DrawRectangleLines(obs.x*CELL, obs.y*CELL, CELL, CELL, BLACK);
+    // obstacles (dark gray/black) and snake body: only visible cells,
+    // looked up in the world grid
+    const auto& snake = game.GetSnake();
+    const Pos& head = snake.front();
+    for (int y = y0; y <= y1; ++y) {
+        int wy = WrapFrom(y, 0, boardRows);
+        for (int x = x0; x <= x1; ++x) {
+            Pos p = { WrapFrom(x, 0, boardCols), wy };
+            unsigned char flags = game.PeekCellFlags(p);
+            if (flags & CELL_OBSTACLE) {
+                DrawRectangle(x*CELL, y*CELL, CELL, CELL, DARKGRAY);
+                DrawRectangleLines(x*CELL, y*CELL, CELL, CELL, BLACK);
+            }
+            if (flags & CELL_SNAKE) {
+                Color c = (p.x == head.x && p.y == head.y) ? BLUE : SKYBLUE;
+                DrawRectangle(x*CELL + 2, y*CELL + 2, CELL-4, CELL-4, c);
+            }
+        }
     }
 
-    // draw foods (multiple) - now as circles
+    // draw foods (multiple) - now as circles, culled to the view
     const auto& foods = game.GetFoods();
     for (const auto& f : foods) {
         if (!f.IsVisible()) continue;
         
         Pos fp = f.GetPosition();
-        int centerX = fp.x * CELL + CELL / 2;
-        int centerY = fp.y * CELL + CELL / 2;
-        int radius = CELL / 2 - 3;
-        
         Color c;
         if (f.IsPoison()) {
             c = DARKGRAY;
         } else {
             c = (f.GetValue() > 10) ? GOLD : RED;
         }
-        
-        DrawCircle(centerX, centerY, radius, c);
-        
-        if (f.IsPoison()) {
-            DrawCircleLines(centerX, centerY, radius, BLACK);
-        }
-    }
+        int radius = CELL / 2 - 3;
 
-    // draw snake
-    const auto& snake = game.GetSnake();
-    for (size_t i = 0; i < snake.size(); ++i) {
-        Color c = (i == 0) ? BLUE : SKYBLUE;
-        DrawRectangle(snake[i].x*CELL + 2, snake[i].y*CELL + 2, CELL-4, CELL-4, c);
+        for (int fy = WrapFrom(fp.y, y0, boardRows); fy <= y1; fy += boardRows) {
+            for (int fx = WrapFrom(fp.x, x0, boardCols); fx <= x1; fx += boardCols) {
+                int centerX = fx * CELL + CELL / 2;
+                int centerY = fy * CELL + CELL / 2;
+                DrawCircle(centerX, centerY, radius, c);
+                if (f.IsPoison()) {
+                    DrawCircleLines(centerX, centerY, radius, BLACK);
+                }
+            }
+        }
     }
 
     // snake eye
     if (snake.size() >= 2) {
-        const Pos& head = snake.front();
         const Pos& neck = snake[1];
         int dx = head.x - neck.x;
         int dy = head.y - neck.y;
-        if (dx > 1) dx = dx - COLS;
-        if (dx < -1) dx = dx + COLS;
-        if (dy > 1) dy = dy - ROWS;
-        if (dy < -1) dy = dy + ROWS;
+        if (dx > 1) dx = dx - boardCols;
+        if (dx < -1) dx = dx + boardCols;
+        if (dy > 1) dy = dy - boardRows;
+        if (dy < -1) dy = dy + boardRows;
 
-        int cx = head.x*CELL + CELL/2;
-        int cy = head.y*CELL + CELL/2;
+        int cx = WrapFrom(head.x, x0, boardCols)*CELL + CELL/2;
+        int cy = WrapFrom(head.y, y0, boardRows)*CELL + CELL/2;
         int eyeOffset = CELL/4;
         if (dx < 0) DrawCircle(cx - eyeOffset/1.5f, cy - eyeOffset/1.5f, 2, BLACK);
         else if (dx > 0) DrawCircle(cx + eyeOffset/1.5f, cy - eyeOffset/1.5f, 2, BLACK);
         else if (dy < 0) DrawCircle(cx - eyeOffset/1.5f, cy - eyeOffset/1.5f, 2, BLACK);
         else if (dy > 0) DrawCircle(cx + eyeOffset/1.5f, cy + eyeOffset/1.5f, 2, BLACK);
     }
+}
+
+void DrawGame(Game& game) {
+    ClearBackground(RAYWHITE);
+    UpdateGameCamera(game);
+
+    float cellPx = CELL * camera.zoom;
+    bool fits = boardCols * cellPx <= WIDTH && boardRows * cellPx <= VIEW_HEIGHT;
+
+    // visible cell range; on a board larger than the view it may extend past
+    // the edges and is wrapped, matching the snake's wrap-around movement
+    Vector2 tl = GetScreenToWorld2D({ 0, 0 }, camera);
+    Vector2 br = GetScreenToWorld2D({ (float)WIDTH, (float)VIEW_HEIGHT }, camera);
+    int x0 = (int)floorf(tl.x / CELL), x1 = (int)floorf(br.x / CELL);
+    int y0 = (int)floorf(tl.y / CELL), y1 = (int)floorf(br.y / CELL);
+    if (fits) {
+        if (x0 < 0) x0 = 0;
+        if (y0 < 0) y0 = 0;
+        if (x1 > boardCols - 1) x1 = boardCols - 1;
+        if (y1 > boardRows - 1) y1 = boardRows - 1;
+    }
+
+    BeginScissorMode(0, 0, WIDTH, VIEW_HEIGHT);
+
+    if (cellPx < OVERVIEW_CELL_PIXELS) {
+        DrawOverview(game, tl, fits);
+    } else {
+        BeginMode2D(camera);
+        DrawBoard(game, x0, x1, y0, y1);
+        EndMode2D();
+    }
+    EndScissorMode();
 
     // HUD area
     DrawRectangle(0, ROWS*CELL, WIDTH, 80, DARKGRAY);
@@ -182,7 +377,16 @@ void DrawGame(Game& game) {
     DrawText(TextFormat("LENGTH: %d", (int)game.GetSnake().size()), 160, ROWS*CELL + 8, 20, WHITE);
     DrawText(TextFormat("LEVEL: %d", game.GetLevel()), 320, ROWS*CELL + 8, 20, WHITE);
     DrawText(TextFormat("BEST: %d", game.GetHighScore()), 8, ROWS*CELL + 36, 18, YELLOW);
-    DrawText("P: Pause | M: Menu", 180, ROWS*CELL + 36, 14, WHITE);
+    DrawText("P: Pause | M: Menu | +/-: Zoom", 180, ROWS*CELL + 36, 14, WHITE);
+
+    // the region in front of the head is too small to hold the snake
+    if (showDangerHint) {
+        int region = game.GetRegionAhead(game.GetDirection());
+        if (region == 0)
+            DrawText("BLOCKED AHEAD", 8, ROWS*CELL + 58, 14, ORANGE);
+        else if (region > 0 && region < (int)game.GetSnake().size())
+            DrawText(TextFormat("DEAD END AHEAD: %d cells", region), 8, ROWS*CELL + 58, 14, ORANGE);
+    }
 }
 
 void DrawPauseOverlay(Game& game) {
@@ -220,7 +424,7 @@ void DrawGameOverOverlay(Game& game) {
     DrawText(scoreText, (WIDTH - scoreWidth) / 2, HEIGHT/2 - 50, 24, WHITE);
     
     // New high score?
-    if (game.GetScore() >= game.GetHighScore() && game.GetScore() > 0) {
+    if (newHighScore) {
         const char* newHigh = "NEW HIGH SCORE!";
         int nhWidth = MeasureText(newHigh, 20);
         DrawText(newHigh, (WIDTH - nhWidth) / 2, HEIGHT/2 - 20, 20, GOLD);
@@ -240,17 +444,66 @@ void DrawGameOverOverlay(Game& game) {
     DrawText("Press R to restart | M for menu", (WIDTH - MeasureText("Press R to restart | M for menu", 14)) / 2, HEIGHT/2 + 145, 14, LIGHTGRAY);
 }
 
-int main() {
+int main(int argc, char** argv) {
     srand((unsigned)time(nullptr));
 
+    // optional board size and procedural world seed: snake <cols> <rows> [seed]
+    if (argc >= 3) {
+        boardCols = atoi(argv[1]);
+        boardRows = atoi(argv[2]);
+        if (boardCols < 8) boardCols = 8;
+        if (boardRows < 8) boardRows = 8;
+    }
+
     InitWindow(WIDTH, HEIGHT, "Snake Game");
     SetTargetFPS(60);
 
-    Game game(COLS, ROWS, 2);
+    Game game(boardCols, boardRows, 2);
+    if (argc >= 4) {
+        game.EnableProceduralWorld(strtoull(argv[3], nullptr, 10));
+    }
+
+    // tuned difficulty (tools/tune); without it the built-in values are used
+    if (FileExists(DIFFICULTY_FILE)) {
+        DifficultyConfig difficulty;
+        std::string error;
+        if (difficulty.Load(DIFFICULTY_FILE, error)) game.SetDifficulty(difficulty);
+        else TraceLog(LOG_WARNING, "difficulty config ignored: %s", error.c_str());
+    }
+
+    // level pack built from levels/default.txt; without it the built-in levels are used
+    game.LoadLevelPack(LEVEL_PACK_FILE);
+#ifdef SNAKE_HOT_RELOAD
+    LevelPackWatcher packWatcher(LEVEL_PACK_FILE);
+#endif
+
+    // checkpoint of the run in progress, written on pause and on exit
+    SessionStore session(SESSION_FILE);
+    // the saved level's layout is built while the menu is up
+    session.Prefetch(game);
+    GameState lastState = game.GetState();
+
+    // the front end learns about score, level and game over from events
+    EventStream events;
+    EventReader frontEndEvents(events);
+    game.SetEventStream(&events);
+    bool exitRequested = false;
+
+    // the next tick is precomputed for every direction while frames are drawn
+    Speculator speculator(game);
 
     lastUpdate = GetTime();
 
-    while (!WindowShouldClose()) {
+    while (!exitRequested && !WindowShouldClose()) {
+#ifdef SNAKE_HOT_RELOAD
+        if (packWatcher.Changed()) {
+            std::string error;
+            if (!game.LoadLevelPack(LEVEL_PACK_FILE, &error))
+                TraceLog(LOG_WARNING, "level pack reload failed: %s", error.c_str());
+            speculator.Cancel();
+        }
+#endif
+
         // Process input based on game state
         InputHandler::Process(game);
         
@@ -259,25 +512,37 @@ int main() {
             break;
         }
 
+        if (IsKeyPressed(KEY_H)) showDangerHint = !showDangerHint;
+
+        // a run started from the menu is recorded from its first tick
+        ProcessGameEvents(frontEndEvents, session, game);
+
         // Update game logic only when playing
         if (game.GetState() == GameState::PLAYING) {
-            int level = game.GetLevel();
-            float base = 0.12f;
-            float decrease = 0.01f * (level - 1);
-            float interval = base - decrease;
-            if (interval < 0.03f) interval = 0.03f;
-
-            if (EventTriggered(interval)) {
-                game.Update();
+            if (EventTriggered(game.GetSpeed())) {
+                if (recording) replay.RecordTick(game.GetDirection());
+                speculator.Tick(game);
             }
         }
 
+        ProcessGameEvents(frontEndEvents, session, game);
+
+        // retried every frame until the worker is free
+        if (game.GetState() == GameState::PLAYING && !speculator.IsCurrent(game))
+            speculator.Start(game);
+
+        // Checkpoint when the game gets paused
+        if (game.GetState() != lastState) {
+            if (game.GetState() == GameState::PAUSED) session.SaveAsync(game);
+            lastState = game.GetState();
+        }
+
         // Draw
         BeginDrawing();
         
         switch (game.GetState()) {
             case GameState::MENU:
-                DrawMenu(game);
+                exitRequested = DrawMenu(game, session);
                 break;
                 
             case GameState::PLAYING:
@@ -298,6 +563,21 @@ int main() {
         EndDrawing();
     }
 
+    // closing the window mid-run keeps the run
+    if (game.GetState() == GameState::PLAYING || game.GetState() == GameState::PAUSED)
+        session.SaveAsync(game);
+    session.Flush();
+
+    Speculator::Stats spec = speculator.GetStats();
+    if (spec.ticks > 0) {
+        TraceLog(LOG_INFO, "speculative ticks: %llu of %llu hit, %.1f us per tick saved net of Start "
+                 "(%.1f us), worst tick %.1f us",
+                 (unsigned long long)spec.hits, (unsigned long long)spec.ticks,
+                 spec.savedSeconds / spec.ticks * 1e6, spec.startSeconds / spec.ticks * 1e6,
+                 spec.worstTickSeconds * 1e6);
+    }
+
+    ReleaseOverview();
     CloseWindow();
     return 0;
 }
\ No newline at end of file
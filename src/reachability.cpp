@@ -0,0 +1,415 @@
+#include "reachability.h"
+#include <algorithm>
+
+// node pool size as a multiple of the cell count
+static const size_t POOL_FACTOR = 2;
+// cells a split search may visit before it gives up and asks for a rebuild
+static const int SPLIT_BUDGET = 4096;
+// entries a journal holds: an ordinary tick changes a dozen, a split
+// relabels the cut-off region
+static const size_t MAX_JOURNAL = 2048;
+
+// the 8 cells around a cell in ring order; even entries are the 4 neighbours
+static const int RING[8][2] = {
+    {0, -1}, {1, -1}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}
+};
+
+// For each mask of free ring cells: one neighbour (bit dir / 2) from every
+// run of consecutive free cells that holds one. Free neighbours in the same
+// run are connected through it, so a split is only possible with 2+ bits.
+struct RingSeeds {
+    uint8_t seeds[256];
+    RingSeeds() {
+        for (int mask = 0; mask < 256; ++mask) {
+            seeds[mask] = 0;
+            int start = -1;
+            for (int i = 0; i < 8; ++i)
+                if (!(mask & (1 << i))) start = i;
+            if (start < 0) continue;
+            unsigned seenRuns = 0;
+            int runs = 0;
+            for (int k = 1; k <= 8; ++k) {
+                int i = (start + k) % 8;
+                if (!(mask & (1 << i))) continue;
+                if (!(mask & (1 << ((i + 7) % 8)))) runs++;
+                if (i % 2 == 0 && !(seenRuns & (1u << runs))) {
+                    seenRuns |= 1u << runs;
+                    seeds[mask] |= 1 << (i / 2);
+                }
+            }
+        }
+    }
+};
+static const RingSeeds RING_SEEDS;
+
+Reachability::Reachability(int cols, int rows)
+    : m_cols(cols),
+      m_rows(rows),
+      m_enabled((int64_t)cols * rows <= MAX_CELLS),
+      m_dirty(true),
+      m_rebuilds(0),
+      m_epoch(0),
+      m_journalNodes(0),
+      m_journalDirty(false),
+      m_journaling(false),
+      m_journalFull(false)
+{
+    for (int i = 0; i < 8; ++i) m_ringOffset[i] = RING[i][1] * cols + RING[i][0];
+    if (!m_enabled) return;
+    // everything is allocated here, so updates and rebuilds never touch the heap
+    size_t cells = (size_t)cols * rows;
+    m_cellNode.assign(cells, -1);
+    m_parent.reserve(cells * POOL_FACTOR);
+    m_size.reserve(cells * POOL_FACTOR);
+    m_mark.assign(cells, 0);
+    m_row.resize(cols);
+    for (auto& q : m_queue) q.reserve(std::min<size_t>(cells, SPLIT_BUDGET) + 4);
+}
+
+Reachability::Reachability(const Reachability& other)
+    : m_cols(other.m_cols),
+      m_rows(other.m_rows),
+      m_enabled(false),
+      m_dirty(true),
+      m_rebuilds(0),
+      m_epoch(0),
+      m_journalNodes(0),
+      m_journalDirty(false),
+      m_journaling(false),
+      m_journalFull(false)
+{
+    *this = other;
+}
+
+Reachability& Reachability::operator=(const Reachability& other) {
+    if (this == &other) return *this;
+    m_cols = other.m_cols;
+    m_rows = other.m_rows;
+    m_enabled = other.m_enabled;
+    m_dirty = other.m_dirty;
+    m_rebuilds = other.m_rebuilds;
+    std::copy(other.m_ringOffset, other.m_ringOffset + 8, m_ringOffset);
+
+    // a plain vector copy would leave no room for new nodes
+    m_parent.reserve(other.m_parent.capacity());
+    m_size.reserve(other.m_size.capacity());
+    m_cellNode = other.m_cellNode;
+    m_parent = other.m_parent;
+    m_size = other.m_size;
+
+    // scratch: only sized, marks restart with a fresh epoch when reallocated
+    if (m_mark.size() != other.m_mark.size()) {
+        m_mark.assign(other.m_mark.size(), 0);
+        m_epoch = 0;
+    }
+    m_row.resize(other.m_row.size());
+    for (int i = 0; i < 4; ++i) m_queue[i].reserve(other.m_queue[i].capacity());
+
+    // the journal is about this object's old state
+    m_journal.clear();
+    m_journaling = false;
+    m_journalFull = false;
+    return *this;
+}
+
+void Reachability::Disable() {
+    m_enabled = false;
+    std::vector<int32_t>().swap(m_cellNode);
+    std::vector<int32_t>().swap(m_parent);
+    std::vector<int32_t>().swap(m_size);
+    std::vector<uint32_t>().swap(m_mark);
+    std::vector<unsigned char>().swap(m_row);
+    for (auto& q : m_queue) std::vector<int32_t>().swap(q);
+}
+
+Pos Reachability::Neighbor(Pos p, int dir) const {
+    p.x += RING[dir][0];
+    p.y += RING[dir][1];
+    if (p.x < 0) p.x += m_cols;
+    else if (p.x >= m_cols) p.x -= m_cols;
+    if (p.y < 0) p.y += m_rows;
+    else if (p.y >= m_rows) p.y -= m_rows;
+    return p;
+}
+
+void Reachability::RingCells(Pos p, int out[8]) const {
+    // away from the edges the ring is fixed offsets from p
+    if (p.x > 0 && p.x < m_cols - 1 && p.y > 0 && p.y < m_rows - 1) {
+        for (int i = 0; i < 8; ++i) out[i] = m_ringOffset[i] + Index(p);
+        return;
+    }
+    for (int i = 0; i < 8; ++i) out[i] = Index(Neighbor(p, i));
+}
+
+int Reachability::Root(int node) const {
+    while (m_parent[node] != node) node = m_parent[node];
+    return node;
+}
+
+int Reachability::FindAndCompress(int node) {
+    while (m_parent[node] != node) {
+        Set(m_parent[node], m_parent[m_parent[node]]);
+        node = m_parent[node];
+    }
+    return node;
+}
+
+int Reachability::NewNode(int size) {
+    // pool full: start over from the World rather than reallocate
+    if (m_parent.size() == m_parent.capacity()) {
+        m_dirty = true;
+        return -1;
+    }
+    int node = (int)m_parent.size();
+    m_parent.push_back(node);
+    m_size.push_back(size);
+    return node;
+}
+
+void Reachability::Union(int a, int b) {
+    a = FindAndCompress(a);
+    b = FindAndCompress(b);
+    if (a == b) return;
+    if (m_size[a] < m_size[b]) std::swap(a, b);
+    Set(m_parent[b], a);
+    Set(m_size[a], m_size[a] + m_size[b]);
+}
+
+void Reachability::Rebuild(const World& world) {
+    if (!m_enabled) return;
+    // far too much to journal
+    if (m_journaling) m_journalFull = true;
+    const int cells = m_cols * m_rows;
+    // one node per run of free cells in a row, numbered by the run's first
+    // cell; a run joins the runs above it that it touches
+    m_parent.clear();
+    m_parent.resize(cells);
+    m_size.clear();
+    m_size.resize(cells);
+    for (int y = 0; y < m_rows; ++y) {
+        world.PeekRow(y, 0, m_cols, m_row.data());
+        const int first = y * m_cols;
+        int x = 0;
+        while (x < m_cols) {
+            if (m_row[x] & (CELL_SNAKE | CELL_OBSTACLE)) {
+                m_cellNode[first + x++] = -1;
+                continue;
+            }
+            const int run = first + x;
+            int end = x;
+            while (end < m_cols && !(m_row[end] & (CELL_SNAKE | CELL_OBSTACLE)))
+                m_cellNode[first + end++] = run;
+            m_parent[run] = run;
+            m_size[run] = end - x;
+            if (y > 0) {
+                int prev = -1;
+                for (int c = run - m_cols; c < first + end - m_cols; ++c) {
+                    int up = m_cellNode[c];
+                    if (up >= 0 && up != prev) Union(run, up);
+                    prev = up;
+                }
+            }
+            x = end;
+        }
+    }
+    // then across the wrapping edges
+    for (int y = 0; y < m_rows; ++y) {
+        int a = m_cellNode[y * m_cols], b = m_cellNode[y * m_cols + m_cols - 1];
+        if (a >= 0 && b >= 0) Union(a, b);
+    }
+    for (int x = 0; x < m_cols; ++x) {
+        int a = m_cellNode[x], b = m_cellNode[(m_rows - 1) * m_cols + x];
+        if (a >= 0 && b >= 0) Union(a, b);
+    }
+    // point every cell at its root so queries start one step away
+    int last = -1, lastRoot = -1;
+    for (int c = 0; c < cells; ++c) {
+        int node = m_cellNode[c];
+        if (node < 0) continue;
+        if (node != last) {
+            last = node;
+            lastRoot = FindAndCompress(node);
+        }
+        m_cellNode[c] = lastRoot;
+    }
+
+    m_dirty = false;
+    m_rebuilds++;
+}
+
+void Reachability::Free(Pos p) {
+    if (!m_enabled || m_dirty) return;
+    int c = Index(p);
+    if (m_cellNode[c] >= 0) return;
+
+    // join the first free neighbour's region; the cell's old node may sit
+    // inside some tree, so it only gets a new one when it stands alone
+    int ring[8];
+    RingCells(p, ring);
+    int node = -1;
+    for (int dir = 0; dir < 8; dir += 2) {
+        int n = m_cellNode[ring[dir]];
+        if (n < 0 || n == node) continue;
+        if (node < 0) {
+            node = FindAndCompress(n);
+            Set(m_size[node], m_size[node] + 1);
+            Set(m_cellNode[c], node);
+        } else {
+            Union(node, n);
+        }
+    }
+    if (node < 0) {
+        node = NewNode(1);
+        if (node >= 0) Set(m_cellNode[c], node);
+    }
+}
+
+void Reachability::Occupy(Pos p) {
+    if (!m_enabled || m_dirty) return;
+    int c = Index(p);
+    int node = m_cellNode[c];
+    if (node < 0) return;
+
+    int root = FindAndCompress(node);
+    Set(m_size[root], m_size[root] - 1);
+    Set(m_cellNode[c], -1);
+    CheckSplit(p);
+}
+
+void Reachability::CheckSplit(Pos p) {
+    // one search per run of free ring cells that holds a neighbour
+    int ring[8];
+    RingCells(p, ring);
+    unsigned mask = 0;
+    for (int i = 0; i < 8; ++i)
+        mask |= (unsigned)(m_cellNode[ring[i]] >= 0) << i;
+    unsigned seedDirs = RING_SEEDS.seeds[mask];
+    if (!(seedDirs & (seedDirs - 1))) return;
+
+    int seeds[4];
+    int searches = 0;
+    for (int k = 0; k < 4; ++k)
+        if (seedDirs & (1u << k)) seeds[searches++] = ring[k * 2];
+
+    // Breadth-first searches from every side, one cell each in turn. Sides
+    // that meet are connected and merge; a side that runs out of cells is
+    // cut off. Done when at most one side is left open.
+    if (++m_epoch >= (1u << 30)) {
+        std::fill(m_mark.begin(), m_mark.end(), 0);
+        m_epoch = 1;
+    }
+    const uint32_t base = m_epoch << 2;
+    int group[4];
+    size_t next[4];
+    bool closed[4] = {};
+    for (int s = 0; s < searches; ++s) {
+        group[s] = s;
+        next[s] = 0;
+        m_queue[s].clear();
+        m_queue[s].push_back(seeds[s]);
+        m_mark[seeds[s]] = base | s;
+    }
+    auto groupOf = [&](int s) {
+        while (group[s] != s) s = group[s];
+        return s;
+    };
+
+    int open = searches;
+    int budget = SPLIT_BUDGET;
+    while (open > 1) {
+        for (int s = 0; s < searches && open > 1; ++s) {
+            std::vector<int32_t>& q = m_queue[s];
+            if (closed[groupOf(s)] || next[s] == q.size()) continue;
+
+            int cell = q[next[s]++];
+            Pos cp = { cell % m_cols, cell / m_cols };
+            for (int dir = 0; dir < 8; dir += 2) {
+                int n = Index(Neighbor(cp, dir));
+                if (m_cellNode[n] < 0) continue;
+                if ((m_mark[n] & ~3u) == base) {
+                    int g = groupOf(s), other = groupOf(m_mark[n] & 3);
+                    if (g != other && !closed[other]) {
+                        group[other] = g;
+                        open--;
+                    }
+                    continue;
+                }
+                if (q.size() == q.capacity()) { m_dirty = true; return; }
+                m_mark[n] = base | s;
+                q.push_back(n);
+            }
+            if (--budget <= 0) { m_dirty = true; return; }
+        }
+
+        // a side whose searches have all run dry is a region of its own
+        for (int g = 0; g < searches && open > 1; ++g) {
+            if (groupOf(g) != g || closed[g]) continue;
+            bool dry = true;
+            for (int s = 0; s < searches; ++s)
+                if (groupOf(s) == g && next[s] < m_queue[s].size()) dry = false;
+            if (!dry) continue;
+
+            int count = 0;
+            for (int s = 0; s < searches; ++s)
+                if (groupOf(s) == g) count += (int)m_queue[s].size();
+            int oldRoot = FindAndCompress(m_cellNode[m_queue[g][0]]);
+            int node = NewNode(count);
+            if (node < 0) return;
+            Set(m_size[oldRoot], m_size[oldRoot] - count);
+            for (int s = 0; s < searches; ++s)
+                if (groupOf(s) == g)
+                    for (int cell : m_queue[s]) Set(m_cellNode[cell], node);
+            closed[g] = true;
+            open--;
+        }
+    }
+}
+
+void Reachability::StartJournal() {
+    if (m_journal.capacity() < MAX_JOURNAL) m_journal.reserve(MAX_JOURNAL);
+    m_journal.clear();
+    m_journalNodes = m_parent.size();
+    m_journalDirty = m_dirty;
+    m_journaling = true;
+    m_journalFull = false;
+}
+
+bool Reachability::StopJournal() {
+    m_journaling = false;
+    return !m_journalFull;
+}
+
+void Reachability::Note(int32_t& slot) {
+    if (m_journal.size() == MAX_JOURNAL) { m_journalFull = true; return; }
+    m_journal.push_back(JournalEntry{&slot, slot});
+}
+
+void Reachability::RollBack() {
+    for (size_t i = m_journal.size(); i-- > 0; ) *m_journal[i].slot = m_journal[i].value;
+    m_journal.clear();
+    // nodes made since are dropped (shrinking never reallocates)
+    m_parent.resize(m_journalNodes);
+    m_size.resize(m_journalNodes);
+    m_dirty = m_journalDirty;
+}
+
+int Reachability::RegionSize(Pos p) const {
+    if (!m_enabled) return -1;
+    int node = m_cellNode[Index(p)];
+    return node < 0 ? 0 : m_size[Root(node)];
+}
+
+bool Reachability::Reachable(Pos from, Pos p) const {
+    if (!m_enabled) return true;
+    int node = m_cellNode[Index(p)];
+    if (node < 0) return false;
+    int root = Root(node);
+
+    int self = m_cellNode[Index(from)];
+    if (self >= 0 && Root(self) == root) return true;
+    for (int dir = 0; dir < 8; dir += 2) {
+        int n = m_cellNode[Index(Neighbor(from, dir))];
+        if (n >= 0 && Root(n) == root) return true;
+    }
+    return false;
+}
@@ -0,0 +1,153 @@
+#include "replay.h"
+#include <cstring>
+#include <fstream>
+
+static const char REPLAY_MAGIC[8] = {'S', 'N', 'K', 'R', 'P', 'L', 'Y', '\0'};
+// ticks reserved up front (about 80 minutes at the fastest speed)
+static const size_t RESERVED_TICKS = 1 << 17;
+// largest board side a replay may name
+static const int MAX_BOARD_SIDE = 4096;
+
+Replay::Replay()
+    : m_cols(0),
+      m_rows(0),
+      m_procedural(false),
+      m_worldSeed(0),
+      m_startSeed(0),
+      m_packChecksum(0),
+      m_difficultyHash(0),
+      m_highScore(0)
+{
+}
+
+void Replay::Begin(const Game& game) {
+    m_cols = game.GetCols();
+    m_rows = game.GetRows();
+    m_procedural = game.GetWorld().IsProcedural();
+    m_worldSeed = game.GetWorld().GetSeed();
+    m_startSeed = game.GetStartSeed();
+    m_packChecksum = game.GetLevelPackChecksum();
+    m_difficultyHash = game.GetDifficulty().Hash();
+    m_highScore = game.GetHighScore();
+    m_dirs.clear();
+    m_dirs.reserve(RESERVED_TICKS);
+}
+
+void Replay::RecordTick(Dir d) {
+    m_dirs.push_back((uint8_t)d);
+}
+
+bool Replay::CheckRules(const Game& game, std::string& error) const {
+    if (game.GetLevelPackChecksum() != m_packChecksum) {
+        error = m_packChecksum ? "recorded with a different level pack" : "recorded without a level pack";
+        return false;
+    }
+    if (game.GetDifficulty().Hash() != m_difficultyHash) {
+        error = "recorded with a different difficulty config";
+        return false;
+    }
+    return true;
+}
+
+void Replay::Start(Game& game) const {
+    if (m_procedural) game.EnableProceduralWorld(m_worldSeed);
+    game.SetSeed(m_startSeed);
+    game.StartGame();
+}
+
+void Replay::Step(Game& game, size_t tick) const {
+    Dir d = TickDirection(tick);
+    // two key presses within one tick can turn the snake around (UP, LEFT,
+    // DOWN); SetDirection refuses the direct reversal, so turn via LEFT/UP
+    Dir cur = game.GetDirection();
+    bool vertical = cur == Dir::UP || cur == Dir::DOWN;
+    if (d != cur && vertical == (d == Dir::UP || d == Dir::DOWN))
+        game.SetDirection(vertical ? Dir::LEFT : Dir::UP);
+    game.SetDirection(d);
+    game.Update();
+}
+
+namespace {
+
+template <typename T>
+void Put(std::ofstream& out, T v) {
+    out.write((const char*)&v, sizeof(T));
+}
+
+template <typename T>
+bool Get(std::ifstream& in, T& v) {
+    return (bool)in.read((char*)&v, sizeof(T));
+}
+
+} // namespace
+
+bool Replay::Save(const std::string& path, std::string& error) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) { error = path + ": cannot write"; return false; }
+    out.write(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    Put<uint32_t>(out, VERSION);
+    Put<int32_t>(out, m_cols);
+    Put<int32_t>(out, m_rows);
+    Put<uint8_t>(out, m_procedural ? 1 : 0);
+    Put<uint64_t>(out, m_worldSeed);
+    Put<uint64_t>(out, m_startSeed);
+    Put<uint64_t>(out, m_packChecksum);
+    Put<uint64_t>(out, m_difficultyHash);
+    Put<int32_t>(out, m_highScore);
+    Put<uint32_t>(out, (uint32_t)m_dirs.size());
+    out.write((const char*)m_dirs.data(), m_dirs.size());
+    if (!out) { error = path + ": write failed"; return false; }
+    return true;
+}
+
+bool Replay::Load(const std::string& path, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) { error = path + ": cannot open"; return false; }
+
+    char magic[8];
+    uint32_t version, ticks;
+    int32_t cols, rows, highScore;
+    uint8_t procedural;
+    uint64_t worldSeed, startSeed, packChecksum, difficultyHash;
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, REPLAY_MAGIC, sizeof(magic)) != 0) {
+        error = path + ": not a replay file";
+        return false;
+    }
+    if (!Get(in, version) || version != VERSION) {
+        error = path + ": unsupported replay version";
+        return false;
+    }
+    if (!Get(in, cols) || !Get(in, rows) || !Get(in, procedural) || !Get(in, worldSeed) ||
+        !Get(in, startSeed) || !Get(in, packChecksum) || !Get(in, difficultyHash) ||
+        !Get(in, highScore) || !Get(in, ticks) || cols < 8 || rows < 8 ||
+        cols > MAX_BOARD_SIDE || rows > MAX_BOARD_SIDE) {
+        error = path + ": bad replay header";
+        return false;
+    }
+
+    // one byte per tick follows; check before sizing the buffer from it
+    std::streamoff headerEnd = in.tellg();
+    in.seekg(0, std::ios::end);
+    std::streamoff fileEnd = in.tellg();
+    in.seekg(headerEnd);
+    if (headerEnd < 0 || fileEnd < 0 || (uint64_t)(fileEnd - headerEnd) < ticks) {
+        error = path + ": truncated replay";
+        return false;
+    }
+
+    std::vector<uint8_t> dirs(ticks);
+    if (!in.read((char*)dirs.data(), dirs.size())) { error = path + ": truncated replay"; return false; }
+    for (uint8_t d : dirs)
+        if (d > (uint8_t)Dir::RIGHT) { error = path + ": bad direction in replay"; return false; }
+
+    m_cols = cols;
+    m_rows = rows;
+    m_procedural = procedural != 0;
+    m_worldSeed = worldSeed;
+    m_startSeed = startSeed;
+    m_packChecksum = packChecksum;
+    m_difficultyHash = difficultyHash;
+    m_highScore = highScore;
+    m_dirs.swap(dirs);
+    return true;
+}
@@ -0,0 +1,151 @@
+#include "session.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+static const char SESSION_MAGIC[8] = {'S', 'N', 'K', 'S', 'A', 'V', 'E', '\0'};
+// snapshots beyond this are rejected as corrupt before allocating for them
+static const uint32_t MAX_PAYLOAD = 64u << 20;
+
+SessionStore::SessionStore(const std::string& path)
+    : m_path(path),
+      m_hasPending(false),
+      m_writing(false),
+      m_stop(false),
+      m_hasSession(false)
+{
+    std::vector<unsigned char> payload;
+    m_hasSession = ReadFile(payload, nullptr);
+    m_writer = std::thread([this] { WriterLoop(); });
+}
+
+SessionStore::~SessionStore() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    m_writer.join();
+}
+
+uint64_t SessionStore::Checksum(const unsigned char* data, size_t size) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= data[i];
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+void SessionStore::SaveAsync(const Game& game) {
+    game.SaveSnapshot(m_snapshot);
+
+    SessionHeader header;
+    memcpy(header.magic, SESSION_MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.payloadSize = (uint32_t)m_snapshot.size();
+    header.checksum = Checksum(m_snapshot.data(), m_snapshot.size());
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // a newer snapshot replaces one that hasn't been written yet
+        m_pending.resize(sizeof(header) + m_snapshot.size());
+        memcpy(m_pending.data(), &header, sizeof(header));
+        memcpy(m_pending.data() + sizeof(header), m_snapshot.data(), m_snapshot.size());
+        m_hasPending = true;
+        m_hasSession = true;
+    }
+    m_wake.notify_one();
+}
+
+void SessionStore::Flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return !m_hasPending && !m_writing; });
+}
+
+bool SessionStore::HasSession() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hasSession;
+}
+
+void SessionStore::Remove() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_hasPending = false;
+    m_idle.wait(lock, [this] { return !m_writing; });
+    std::remove(m_path.c_str());
+    m_hasSession = false;
+}
+
+bool SessionStore::Load(Game& game, std::string* error) {
+    Flush();
+    std::vector<unsigned char> payload;
+    if (!ReadFile(payload, error)) return false;
+    if (!game.LoadSnapshot(payload.data(), payload.size(), error)) {
+        if (error) *error = m_path + ": " + *error;
+        return false;
+    }
+    return true;
+}
+
+void SessionStore::Prefetch(Game& game) const {
+    std::vector<unsigned char> payload;
+    if (ReadFile(payload, nullptr)) game.PrefetchSnapshot(payload.data(), payload.size());
+}
+
+bool SessionStore::ReadFile(std::vector<unsigned char>& payload, std::string* error) const {
+    auto fail = [&](const std::string& why) {
+        if (error) *error = m_path + ": " + why;
+        return false;
+    };
+
+    std::ifstream in(m_path, std::ios::binary);
+    if (!in) return fail("no saved session");
+
+    SessionHeader header;
+    if (!in.read((char*)&header, sizeof(header))) return fail("truncated header");
+    if (memcmp(header.magic, SESSION_MAGIC, sizeof(header.magic)) != 0) return fail("not a session file");
+    if (header.version != VERSION)
+        return fail("saved by format version " + std::to_string(header.version) +
+                    ", expected " + std::to_string(VERSION));
+    if (header.payloadSize > MAX_PAYLOAD) return fail("bad payload size");
+
+    payload.resize(header.payloadSize);
+    if (!in.read((char*)payload.data(), payload.size())) return fail("truncated payload");
+    if (Checksum(payload.data(), payload.size()) != header.checksum) return fail("checksum mismatch");
+    return true;
+}
+
+void SessionStore::WriterLoop() {
+    std::vector<unsigned char> buffer;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [this] { return m_stop || m_hasPending; });
+        if (!m_hasPending) return;  // stopping with nothing left to write
+
+        buffer.swap(m_pending);
+        m_hasPending = false;
+        m_writing = true;
+        lock.unlock();
+
+        // write to a temporary name and rename, like the level pack compiler
+        std::string tmpPath = m_path + ".tmp";
+        bool ok;
+        {
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            out.write((const char*)buffer.data(), buffer.size());
+            ok = (bool)out;
+        }
+        if (ok) {
+            std::remove(m_path.c_str()); // rename doesn't replace on Windows
+            ok = std::rename(tmpPath.c_str(), m_path.c_str()) == 0;
+        }
+        if (!ok) {
+            fprintf(stderr, "session: cannot write %s\n", m_path.c_str());
+            std::remove(tmpPath.c_str());
+        }
+
+        lock.lock();
+        m_writing = false;
+        m_idle.notify_all();
+    }
+}
@@ -0,0 +1,182 @@
+#include "snake_env.h"
+#include "game.h"
+#include "thread_pool.h"
+#include "rng.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+
+// envs handed to one thread pool item in snake_env_step_batch
+static const int BATCH_BLOCK = 64;
+// mixed into a reset seed to get the seeds of the auto-reset episodes
+static const uint64_t EPISODE_SALT = 0xE915D0DE5EEDull;
+
+struct SnakeEnv {
+    SnakeEnv(int cols, int rows) : game(cols, rows), episodes(0) {}
+
+    Game game;
+    Rng episodes;  // seeds for episodes started by snake_env_step_batch
+};
+
+namespace {
+
+std::atomic<uint64_t> g_steps(0);
+std::atomic<uint64_t> g_nanoseconds(0);
+
+typedef std::chrono::steady_clock Clock;
+
+void Record(uint64_t steps, Clock::time_point start) {
+    uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now() - start).count();
+    g_steps.fetch_add(steps, std::memory_order_relaxed);
+    g_nanoseconds.fetch_add(ns, std::memory_order_relaxed);
+}
+
+size_t PlaneSize(const SnakeEnv* env) {
+    return (size_t)env->game.GetCols() * env->game.GetRows();
+}
+
+// clear the planes, then mark only occupied cells: cost follows the number
+// of snake cells, foods and obstacles, not a lookup per board cell
+void WriteObservation(const SnakeEnv* env, uint8_t* obs) {
+    const Game& game = env->game;
+    const int cols = game.GetCols();
+    const size_t plane = PlaneSize(env);
+    memset(obs, 0, plane * SNAKE_ENV_CHANNELS);
+
+    auto at = [&](int channel, Pos p) -> uint8_t& {
+        return obs[channel * plane + (size_t)p.y * cols + p.x];
+    };
+
+    const std::vector<Pos>& snake = game.GetSnake();
+    for (const auto& p : snake) at(SNAKE_ENV_CH_SNAKE, p) = 1;
+    if (!snake.empty()) at(SNAKE_ENV_CH_HEAD, snake.front()) = 1;
+
+    for (const auto& f : game.GetFoods()) {
+        if (!f.IsVisible()) continue;
+        at(f.IsPoison() ? SNAKE_ENV_CH_POISON : SNAKE_ENV_CH_FOOD, f.GetPosition()) = 1;
+    }
+
+    for (const auto& p : game.GetObstacles()) at(SNAKE_ENV_CH_OBSTACLE, p) = 1;
+}
+
+void Reset(SnakeEnv* env, uint64_t seed) {
+    env->game.SetSeed(seed);
+    env->episodes.Seed(seed ^ EPISODE_SALT);
+    env->game.StartGame();
+}
+
+void Step(SnakeEnv* env, int action, SnakeEnvStep* result) {
+    Game& game = env->game;
+    if (action >= SNAKE_ENV_UP && action <= SNAKE_ENV_RIGHT)
+        game.SetDirection((Dir)action);
+
+    int before = game.GetScore();
+    bool wasOver = game.IsGameOver();
+    game.Update();
+
+    if (!result) return;
+    bool died = !wasOver && game.IsGameOver();
+    result->reward = died ? SNAKE_ENV_DEATH_REWARD : (float)(game.GetScore() - before);
+    result->done = game.IsGameOver() ? 1 : 0;
+    result->score = game.GetScore();
+    result->length = (int32_t)game.GetSnake().size();
+}
+
+// Dir values are used as actions directly
+static_assert((int)Dir::UP == SNAKE_ENV_UP && (int)Dir::DOWN == SNAKE_ENV_DOWN &&
+              (int)Dir::LEFT == SNAKE_ENV_LEFT && (int)Dir::RIGHT == SNAKE_ENV_RIGHT,
+              "action values must match Dir");
+
+// arguments of one snake_env_step_batch call, shared with the pool items
+struct Batch {
+    SnakeEnv* const* envs;
+    int count;
+    const int* actions;
+    uint8_t* obs;
+    SnakeEnvStep* results;
+
+    void RunBlock(size_t block) const {
+        int begin = (int)block * BATCH_BLOCK;
+        int end = begin + BATCH_BLOCK < count ? begin + BATCH_BLOCK : count;
+        for (int i = begin; i < end; ++i) {
+            SnakeEnv* env = envs[i];
+            SnakeEnvStep step;
+            Step(env, actions[i], &step);
+            if (step.done) Reset(env, env->episodes.Next());
+            if (results) results[i] = step;
+            if (obs) WriteObservation(env, obs + (size_t)i * PlaneSize(env) * SNAKE_ENV_CHANNELS);
+        }
+    }
+};
+
+} // namespace
+
+extern "C" {
+
+int snake_env_abi_version(void) {
+    return SNAKE_ENV_ABI_VERSION;
+}
+
+SnakeEnv* snake_env_create(int cols, int rows, uint64_t seed) {
+    if (cols < 8 || rows < 8) return nullptr;
+    SnakeEnv* env = new (std::nothrow) SnakeEnv(cols, rows);
+    if (!env) return nullptr;
+    // no high score file: many environments run side by side
+    env->game.SetHighScoreFile("");
+    Reset(env, seed);
+    return env;
+}
+
+void snake_env_destroy(SnakeEnv* env) {
+    delete env;
+}
+
+size_t snake_env_observation_size(const SnakeEnv* env) {
+    return PlaneSize(env) * SNAKE_ENV_CHANNELS;
+}
+
+void snake_env_reset(SnakeEnv* env, uint64_t seed, uint8_t* obs) {
+    Reset(env, seed);
+    if (obs) WriteObservation(env, obs);
+}
+
+void snake_env_step(SnakeEnv* env, int action, uint8_t* obs, SnakeEnvStep* result) {
+    Clock::time_point start = Clock::now();
+    Step(env, action, result);
+    if (obs) WriteObservation(env, obs);
+    Record(1, start);
+}
+
+void snake_env_step_batch(SnakeEnv* const* envs, int count, const int* actions,
+                          uint8_t* obs, SnakeEnvStep* results, int threads) {
+    if (count <= 0) return;
+    Clock::time_point start = Clock::now();
+
+    const Batch batch = {envs, count, actions, obs, results};
+    size_t blocks = (size_t)(count + BATCH_BLOCK - 1) / BATCH_BLOCK;
+    if (threads) {
+        // capture one pointer so the std::function doesn't allocate
+        const Batch* b = &batch;
+        ThreadPool::Shared().ParallelFor(blocks, [b](size_t block) { b->RunBlock(block); });
+    } else {
+        for (size_t block = 0; block < blocks; ++block) batch.RunBlock(block);
+    }
+
+    Record((uint64_t)count, start);
+}
+
+void snake_env_get_stats(SnakeEnvStats* stats) {
+    if (!stats) return;
+    stats->steps = g_steps.load(std::memory_order_relaxed);
+    stats->seconds = (double)g_nanoseconds.load(std::memory_order_relaxed) * 1e-9;
+    stats->steps_per_second = stats->seconds > 0.0 ? (double)stats->steps / stats->seconds : 0.0;
+}
+
+void snake_env_reset_stats(void) {
+    g_steps.store(0, std::memory_order_relaxed);
+    g_nanoseconds.store(0, std::memory_order_relaxed);
+}
+
+} // extern "C"
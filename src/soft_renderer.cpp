@@ -0,0 +1,309 @@
+#include "soft_renderer.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// same geometry as the game window (src/main.cpp)
+static const int CELL = 24;
+static const int VIEW_WIDTH = SoftRenderer::WIDTH;
+static const int VIEW_HEIGHT = 480;  // play area above the 80 px HUD
+
+namespace {
+
+// Frames are drawn as indices into the few raylib colors DrawGame uses,
+// so fills are memsets and color conversion is a table lookup
+enum Color : uint8_t {
+    RAYWHITE, GRID, DARKGRAY, BLACK, SKYBLUE, BLUE, RED, GOLD, YELLOW, WHITE, COLOR_COUNT
+};
+
+const uint8_t PALETTE[COLOR_COUNT][3] = {
+    { 245, 245, 245 },  // RAYWHITE
+    { 241, 241, 241 },  // Fade(LIGHTGRAY, 0.08f) on RAYWHITE
+    { 80, 80, 80 },     // DARKGRAY
+    { 0, 0, 0 },        // BLACK
+    { 102, 191, 255 },  // SKYBLUE
+    { 0, 121, 241 },    // BLUE
+    { 230, 41, 55 },    // RED
+    { 255, 203, 0 },    // GOLD
+    { 253, 249, 0 },    // YELLOW
+    { 255, 255, 255 },  // WHITE
+};
+
+// BT.601 studio range Y, U and V of every palette color
+struct YuvTable {
+    uint8_t y[COLOR_COUNT], u[COLOR_COUNT], v[COLOR_COUNT];
+
+    YuvTable() {
+        for (int i = 0; i < COLOR_COUNT; ++i) {
+            int r = PALETTE[i][0], g = PALETTE[i][1], b = PALETTE[i][2];
+            y[i] = (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+            u[i] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            v[i] = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+};
+const YuvTable YUV;
+
+// Classic 5x7 font for ASCII 0x20..0x7E: five columns per glyph, bit 0 is
+// the top row. Close to raylib's default font in size and spacing.
+const uint8_t FONT[95][5] = {
+    {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},
+    {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x55,0x22,0x50}, {0x00,0x05,0x03,0x00,0x00},
+    {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x08,0x2A,0x1C,0x2A,0x08}, {0x08,0x08,0x3E,0x08,0x08},
+    {0x00,0x50,0x30,0x00,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x60,0x60,0x00,0x00}, {0x20,0x10,0x08,0x04,0x02},
+    {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x42,0x61,0x51,0x49,0x46}, {0x21,0x41,0x45,0x4B,0x31},
+    {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x30}, {0x01,0x71,0x09,0x05,0x03},
+    {0x36,0x49,0x49,0x49,0x36}, {0x06,0x49,0x49,0x29,0x1E}, {0x00,0x36,0x36,0x00,0x00}, {0x00,0x56,0x36,0x00,0x00},
+    {0x08,0x14,0x22,0x41,0x00}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x51,0x09,0x06},
+    {0x32,0x49,0x79,0x41,0x3E}, {0x7E,0x11,0x11,0x11,0x7E}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},
+    {0x7F,0x41,0x41,0x22,0x1C}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01}, {0x3E,0x41,0x49,0x49,0x7A},
+    {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},
+    {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x0C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},
+    {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x46,0x49,0x49,0x49,0x31},
+    {0x01,0x01,0x7F,0x01,0x01}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F},
+    {0x63,0x14,0x08,0x14,0x63}, {0x07,0x08,0x70,0x08,0x07}, {0x61,0x51,0x49,0x45,0x43}, {0x00,0x7F,0x41,0x41,0x00},
+    {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x7F,0x00}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},
+    {0x00,0x01,0x02,0x04,0x00}, {0x20,0x54,0x54,0x54,0x78}, {0x7F,0x48,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x20},
+    {0x38,0x44,0x44,0x48,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x08,0x7E,0x09,0x01,0x02}, {0x0C,0x52,0x52,0x52,0x3E},
+    {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x44,0x3D,0x00}, {0x7F,0x10,0x28,0x44,0x00},
+    {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x18,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},
+    {0x7C,0x14,0x14,0x14,0x08}, {0x08,0x14,0x14,0x18,0x7C}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x20},
+    {0x04,0x3F,0x44,0x40,0x20}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},
+    {0x44,0x28,0x10,0x28,0x44}, {0x0C,0x50,0x50,0x50,0x3C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},
+    {0x00,0x00,0x7F,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x08,0x04,0x08,0x10,0x08},
+};
+
+// Drawing target: the frame's color indices and the rows drawing may touch
+// (the board is clipped to the play area like the game's scissor mode)
+struct Canvas {
+    uint8_t* pixels;
+    int clipTop, clipBottom;
+};
+
+void FillRect(const Canvas& cv, int x, int y, int w, int h, Color c) {
+    int xa = x < 0 ? 0 : x, xb = x + w > VIEW_WIDTH ? VIEW_WIDTH : x + w;
+    int ya = y < cv.clipTop ? cv.clipTop : y, yb = y + h > cv.clipBottom ? cv.clipBottom : y + h;
+    if (xa >= xb) return;
+    for (int py = ya; py < yb; ++py) memset(cv.pixels + (size_t)py * VIEW_WIDTH + xa, c, xb - xa);
+}
+
+// one pixel wide border inside the rectangle (DrawRectangleLines)
+void RectLines(const Canvas& cv, int x, int y, int w, int h, Color c) {
+    FillRect(cv, x, y, w, 1, c);
+    FillRect(cv, x, y + h - 1, w, 1, c);
+    FillRect(cv, x, y + 1, 1, h - 2, c);
+    FillRect(cv, x + w - 1, y + 1, 1, h - 2, c);
+}
+
+// pixels whose centers are within radius of (cx, cy); with outline, only
+// the outermost pixel ring (DrawCircleLines)
+void Circle(const Canvas& cv, int cx, int cy, int radius, Color c, bool outline = false) {
+    float r2 = (float)radius * radius;
+    float inner2 = outline ? (float)(radius - 1) * (radius - 1) : -1.0f;
+    for (int py = cy - radius; py < cy + radius; ++py) {
+        if (py < cv.clipTop || py >= cv.clipBottom) continue;
+        float dy = py + 0.5f - cy;
+        for (int px = cx - radius; px < cx + radius; ++px) {
+            if (px < 0 || px >= VIEW_WIDTH) continue;
+            float dx = px + 0.5f - cx;
+            float d2 = dx * dx + dy * dy;
+            if (d2 <= r2 && d2 > inner2) cv.pixels[(size_t)py * VIEW_WIDTH + px] = c;
+        }
+    }
+}
+
+// DrawText with the built-in font: glyphs scaled by size/10 with one
+// scaled column of spacing
+void Text(const Canvas& cv, const char* text, int x, int y, int size, Color c) {
+    float scale = size / 10.0f;
+    // font rows 0..6 sit in a 10 unit tall line, one unit from the top
+    int rowTop[8];
+    for (int r = 0; r <= 7; ++r) rowTop[r] = y + (int)((r + 1) * scale);
+    float penX = (float)x;
+    for (const char* s = text; *s; ++s) {
+        unsigned ch = (unsigned char)*s;
+        const uint8_t* glyph = FONT[(ch >= 0x20 && ch <= 0x7E ? ch : '?') - 0x20];
+        for (int col = 0; col < 5; ++col) {
+            int xa = (int)(penX + col * scale), xb = (int)(penX + (col + 1) * scale);
+            for (int r = 0; r < 7; ++r)
+                if (glyph[col] & (1 << r)) FillRect(cv, xa, rowTop[r], xb - xa, rowTop[r + 1] - rowTop[r], c);
+        }
+        penX += 6 * scale;
+    }
+}
+
+int FloorDiv(int v, int d) {
+    return v >= 0 ? v / d : -((-v + d - 1) / d);
+}
+
+// Map v onto the copy of its wrapped coordinate that is >= lo
+int WrapFrom(int v, int lo, int size) {
+    return lo + ((v - lo) % size + size) % size;
+}
+
+} // namespace
+
+void FrameState::Capture(const Game& game, int highScore) {
+    const int boardCols = game.GetCols();
+    const int boardRows = game.GetRows();
+    const auto& snake = game.GetSnake();
+    const Pos& head = snake.front();
+
+    // camera: center the board if it fits, else follow the head
+    bool fits = boardCols * CELL <= VIEW_WIDTH && boardRows * CELL <= VIEW_HEIGHT;
+    int targetX = fits ? boardCols * CELL / 2 : head.x * CELL + CELL / 2;
+    int targetY = fits ? boardRows * CELL / 2 : head.y * CELL + CELL / 2;
+    originX = targetX - VIEW_WIDTH / 2;
+    originY = targetY - VIEW_HEIGHT / 2;
+
+    x0 = FloorDiv(originX, CELL);
+    y0 = FloorDiv(originY, CELL);
+    int x1 = FloorDiv(originX + VIEW_WIDTH, CELL);
+    int y1 = FloorDiv(originY + VIEW_HEIGHT, CELL);
+    if (fits) {
+        if (x0 < 0) x0 = 0;
+        if (y0 < 0) y0 = 0;
+        if (x1 > boardCols - 1) x1 = boardCols - 1;
+        if (y1 > boardRows - 1) y1 = boardRows - 1;
+    }
+    if (x1 - x0 + 1 > VIEW_CELLS) x1 = x0 + VIEW_CELLS - 1;
+    if (y1 - y0 + 1 > VIEW_CELLS) y1 = y0 + VIEW_CELLS - 1;
+    cols = x1 - x0 + 1;
+    rows = y1 - y0 + 1;
+
+    for (int y = 0; y < rows; ++y) {
+        int wy = WrapFrom(y0 + y, 0, boardRows);
+        for (int x = 0; x < cols; ++x) {
+            Pos p = { WrapFrom(x0 + x, 0, boardCols), wy };
+            unsigned char flags = game.PeekCellFlags(p);
+            uint8_t c = 0;
+            if (flags & CELL_OBSTACLE) c |= OBSTACLE;
+            if (flags & CELL_SNAKE) c |= (p.x == head.x && p.y == head.y) ? SNAKE | HEAD : SNAKE;
+            cells[y * VIEW_CELLS + x] = c;
+        }
+    }
+
+    for (const auto& f : game.GetFoods()) {
+        if (!f.IsVisible()) continue;
+        Pos fp = f.GetPosition();
+        uint8_t c = FOOD;
+        if (f.IsPoison()) c |= POISON;
+        else if (f.GetValue() > 10) c |= GOLD;
+        for (int fy = WrapFrom(fp.y, y0, boardRows); fy <= y1; fy += boardRows)
+            for (int fx = WrapFrom(fp.x, x0, boardCols); fx <= x1; fx += boardCols)
+                cells[(fy - y0) * VIEW_CELLS + (fx - x0)] |= c;
+    }
+
+    // eye on the side the head is moving to
+    eye = false;
+    if (snake.size() >= 2) {
+        const Pos& neck = snake[1];
+        int dx = head.x - neck.x;
+        int dy = head.y - neck.y;
+        if (dx > 1) dx = dx - boardCols;
+        if (dx < -1) dx = dx + boardCols;
+        if (dy > 1) dy = dy - boardRows;
+        if (dy < -1) dy = dy + boardRows;
+
+        int cx = WrapFrom(head.x, x0, boardCols) * CELL + CELL / 2 - originX;
+        int cy = WrapFrom(head.y, y0, boardRows) * CELL + CELL / 2 - originY;
+        int offset = (int)((CELL / 4) / 1.5f);
+        eye = dx != 0 || dy != 0;
+        eyeX = cx + (dx > 0 || (dx == 0 && dy > 0) ? offset : -offset);
+        eyeY = cy + (dx == 0 && dy > 0 ? offset : -offset);
+    }
+
+    score = game.GetScore();
+    length = (int)snake.size();
+    level = game.GetLevel();
+    best = highScore;
+}
+
+void SoftRenderer::Render(const FrameState& frame, uint8_t* pixels) {
+    Canvas view = { pixels, 0, VIEW_HEIGHT };
+    Canvas full = { pixels, 0, HEIGHT };
+
+    FillRect(full, 0, 0, WIDTH, VIEW_HEIGHT, RAYWHITE);
+
+    // cell (x, y) of the frame has its top-left corner at (sx, sy)
+    const int sx0 = frame.x0 * CELL - frame.originX;
+    const int sy0 = frame.y0 * CELL - frame.originY;
+    FillRect(view, sx0, sy0, frame.cols * CELL, frame.rows * CELL, GRID);
+
+    for (int y = 0; y < frame.rows; ++y) {
+        int sy = sy0 + y * CELL;
+        for (int x = 0; x < frame.cols; ++x) {
+            uint8_t c = frame.cells[y * FrameState::VIEW_CELLS + x];
+            if (!(c & (FrameState::OBSTACLE | FrameState::SNAKE))) continue;
+            int sx = sx0 + x * CELL;
+            if (c & FrameState::OBSTACLE) {
+                FillRect(view, sx, sy, CELL, CELL, DARKGRAY);
+                RectLines(view, sx, sy, CELL, CELL, BLACK);
+            }
+            if (c & FrameState::SNAKE)
+                FillRect(view, sx + 2, sy + 2, CELL - 4, CELL - 4, (c & FrameState::HEAD) ? BLUE : SKYBLUE);
+        }
+    }
+
+    // foods on top of the snake, as in DrawBoard
+    const int radius = CELL / 2 - 3;
+    for (int y = 0; y < frame.rows; ++y) {
+        for (int x = 0; x < frame.cols; ++x) {
+            uint8_t c = frame.cells[y * FrameState::VIEW_CELLS + x];
+            if (!(c & FrameState::FOOD)) continue;
+            int cx = sx0 + x * CELL + CELL / 2;
+            int cy = sy0 + y * CELL + CELL / 2;
+            if (c & FrameState::POISON) {
+                Circle(view, cx, cy, radius, DARKGRAY);
+                Circle(view, cx, cy, radius, BLACK, true);
+            } else {
+                Circle(view, cx, cy, radius, (c & FrameState::GOLD) ? GOLD : RED);
+            }
+        }
+    }
+
+    if (frame.eye) Circle(view, frame.eyeX, frame.eyeY, 2, BLACK);
+
+    // HUD
+    char line[32];
+    FillRect(full, 0, VIEW_HEIGHT, WIDTH, HEIGHT - VIEW_HEIGHT, DARKGRAY);
+    snprintf(line, sizeof(line), "SCORE: %d", frame.score);
+    Text(full, line, 8, VIEW_HEIGHT + 8, 20, WHITE);
+    snprintf(line, sizeof(line), "LENGTH: %d", frame.length);
+    Text(full, line, 160, VIEW_HEIGHT + 8, 20, WHITE);
+    snprintf(line, sizeof(line), "LEVEL: %d", frame.level);
+    Text(full, line, 320, VIEW_HEIGHT + 8, 20, WHITE);
+    snprintf(line, sizeof(line), "BEST: %d", frame.best);
+    Text(full, line, 8, VIEW_HEIGHT + 36, 18, YELLOW);
+    Text(full, "P: Pause | M: Menu | +/-: Zoom", 180, VIEW_HEIGHT + 36, 14, WHITE);
+}
+
+void SoftRenderer::ToRgb(const uint8_t* pixels, uint8_t* rgb) {
+    for (size_t i = 0; i < PIXELS_SIZE; ++i, rgb += 3) memcpy(rgb, PALETTE[pixels[i]], 3);
+}
+
+void SoftRenderer::ToI420(const uint8_t* pixels, uint8_t* yuv) {
+    uint8_t* yPlane = yuv;
+    uint8_t* uPlane = yuv + PIXELS_SIZE;
+    uint8_t* vPlane = uPlane + PIXELS_SIZE / 4;
+
+    for (size_t i = 0; i < PIXELS_SIZE; ++i) yPlane[i] = YUV.y[pixels[i]];
+
+    // chroma of each 2x2 block: mean of the four pixels' U and V
+    for (int y = 0; y < HEIGHT / 2; ++y) {
+        const uint8_t* row0 = pixels + (size_t)(2 * y) * WIDTH;
+        const uint8_t* row1 = row0 + WIDTH;
+        uint8_t* u = uPlane + (size_t)y * (WIDTH / 2);
+        uint8_t* v = vPlane + (size_t)y * (WIDTH / 2);
+        for (int x = 0; x < WIDTH / 2; ++x) {
+            uint8_t a = row0[2 * x], b = row0[2 * x + 1], c = row1[2 * x], d = row1[2 * x + 1];
+            if (a == b && a == c && a == d) {
+                u[x] = YUV.u[a];
+                v[x] = YUV.v[a];
+            } else {
+                u[x] = (uint8_t)((YUV.u[a] + YUV.u[b] + YUV.u[c] + YUV.u[d] + 2) >> 2);
+                v[x] = (uint8_t)((YUV.v[a] + YUV.v[b] + YUV.v[c] + YUV.v[d] + 2) >> 2);
+            }
+        }
+    }
+}
@@ -0,0 +1,286 @@
+#include "speculator.h"
+#include "zobrist.h"
+#include <algorithm>
+#include <chrono>
+
+// weight of the latest speculated tick in the running gain
+static const double GAIN_WEIGHT = 1.0 / 16;
+
+static double SecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// state hash with the queued direction taken out: SetDirection between
+// Start and Tick doesn't make a speculation stale
+static uint64_t StateKey(const Game& game) {
+    return game.GetStateHash() ^ Zobrist::Direction((int)game.GetDirection());
+}
+
+// SetDirection refuses a reversal, but a player can still get there between
+// two ticks by turning twice; the state hash only sees the final direction
+static void SteerTo(Game& game, Dir d) {
+    game.SetDirection(d);
+    if (game.GetDirection() == d) return;
+    game.SetDirection(d == Dir::UP || d == Dir::DOWN ? Dir::LEFT : Dir::UP);
+    game.SetDirection(d);
+}
+
+Speculator::Speculator(const Game& game)
+    : m_branchState{BranchState::LOST, BranchState::LOST, BranchState::LOST},
+      m_triedDir{Dir::RIGHT, Dir::UP, Dir::DOWN},
+      m_branchDir{Dir::RIGHT, Dir::UP, Dir::DOWN},
+      m_branchSeconds{0.0, 0.0, 0.0},
+      m_active(false),
+      m_baseTick(0),
+      m_baseKey(0),
+      m_stats(),
+      m_copies(0),
+      m_multicore(std::thread::hardware_concurrency() != 1),
+      m_skipping(false),
+      m_gain(0.0),
+      m_startSeconds(0.0),
+      m_sinceProbe(0),
+      m_replayCount(0),
+      m_replayLost(false),
+      m_jobReplayCount(0),
+      m_pending(false),
+      m_busy(false),
+      m_running(-1),
+      m_done(0),
+      m_stop(false),
+      m_inStep(false),
+      m_cancel(false)
+{
+    m_branches.reserve(3);
+    m_readers.reserve(3);
+    for (int i = 0; i < 3; ++i) {
+        m_branches.emplace_back(game.GetCols(), game.GetRows());
+        m_branches[i].SetHighScoreFile("");
+        m_branches[i].SetEventStream(&m_streams[i]);
+        m_readers.emplace_back(m_streams[i]);
+    }
+    m_worker = std::thread([this] { WorkerLoop(); });
+}
+
+Speculator::~Speculator() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_cancel = true;
+    }
+    m_wake.notify_all();
+    m_worker.join();
+}
+
+bool Speculator::Start(const Game& game) {
+    if (game.GetState() != GameState::PLAYING || game.IsGameOver()) return false;
+    if (IsCurrent(game)) return true;
+    // not worth it lately: wait for the next probe, but now and then let the
+    // worker catch the branches up, so that the probe needn't copy the game
+    bool speculate = m_multicore && (m_gain >= 0.0 || m_sinceProbe >= PROBE_TICKS);
+    m_skipping = !speculate;
+    if (!speculate && (!m_multicore || m_replayCount < CATCH_UP_TICKS)) return false;
+
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_busy || (!speculate && (!m_inStep || m_replayLost))) {
+        lock.unlock();
+        m_startSeconds += SecondsSince(start);
+        return false;
+    }
+
+    // the worker is idle, so the branches can be reset from here; it copies
+    // the one made here into the others
+    if (!m_inStep || m_replayLost) {
+        m_branches[0].CopyStateFrom(game);
+        m_branchState[0] = BranchState::BASE;
+        m_branchState[1] = BranchState::LOST;
+        m_branchState[2] = BranchState::LOST;
+        m_replayCount = 0;
+        m_replayLost = false;
+        m_inStep = true;
+        m_stats.resyncs++;
+    }
+    std::copy(m_replay, m_replay + m_replayCount, m_jobReplay);
+    m_jobReplayCount = m_replayCount;
+    m_replayCount = 0;
+
+    // straight on first, it's the likeliest input
+    Dir d = game.GetDirection();
+    bool vertical = d == Dir::UP || d == Dir::DOWN;
+    m_branchDir[0] = d;
+    m_branchDir[1] = vertical ? Dir::LEFT : Dir::UP;
+    m_branchDir[2] = vertical ? Dir::RIGHT : Dir::DOWN;
+
+    m_active = speculate;
+    m_baseTick = game.GetTick();
+    m_baseKey = StateKey(game);
+    m_cancel = !speculate;
+    m_pending = true;
+    m_busy = true;
+    m_running = -1;
+    m_done = 0;
+    lock.unlock();
+    m_wake.notify_one();
+    m_startSeconds += SecondsSince(start);
+    return speculate;
+}
+
+bool Speculator::IsCurrent(const Game& game) const {
+    return m_active && game.GetTick() == m_baseTick && StateKey(game) == m_baseKey;
+}
+
+void Speculator::Cancel() {
+    m_active = false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cancel = true;
+    m_inStep = false;
+}
+
+void Speculator::Tick(Game& game) {
+    auto start = std::chrono::steady_clock::now();
+    m_stats.ticks++;
+
+    // the branches replay this tick with the direction it is played with
+    uint64_t tick = game.GetTick();
+    Dir dir = game.GetDirection();
+
+    bool speculated = IsCurrent(game);
+    int branch = -1;
+    bool late = false;
+    if (speculated) {
+        for (int i = 0; i < 3; ++i)
+            if (m_branchDir[i] == dir) branch = i;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        // a branch the worker is on finishes sooner than a fresh Update;
+        // one it hasn't begun is left to us
+        if (branch >= 0) m_branchDone.wait(lock, [&] { return m_running != branch; });
+        if (branch >= 0 && m_done <= branch) {
+            // a worker that found no branch in step tried none
+            late = m_inStep;
+            branch = -1;
+        }
+        // the other branches are of no use any more
+        m_cancel = true;
+        // the game's old state, swapped in below, is the one Start saw
+        if (branch >= 0) m_branchState[branch] = BranchState::BASE;
+    }
+    // whatever happens, the speculation was for this tick only
+    m_active = false;
+
+    double seconds, plainSeconds;
+    if (branch < 0) {
+        if (late) m_stats.late++;
+        else if (!speculated && m_skipping) m_stats.skipped++;
+        else m_stats.missed++;
+        auto update = std::chrono::steady_clock::now();
+        game.Update();
+        plainSeconds = SecondsSince(update);
+        RecordTick(tick, game.GetTick(), dir);
+        seconds = SecondsSince(start);
+        m_stats.missSeconds += seconds;
+    } else {
+        game.SwapState(m_branches[branch]);
+        RecordTick(tick, game.GetTick(), dir);
+        EventStream* events = game.GetEventStream();
+        GameEvent event;
+        while (m_readers[branch].Next(event))
+            if (events) events->Publish(event);
+
+        plainSeconds = m_branchSeconds[branch];
+        seconds = SecondsSince(start);
+        m_stats.hits++;
+        m_stats.hitSeconds += seconds;
+        m_stats.worstUpdateSeconds = std::max(m_stats.worstUpdateSeconds, plainSeconds);
+    }
+    m_stats.plainSeconds += plainSeconds;
+    m_stats.worstTickSeconds = std::max(m_stats.worstTickSeconds, seconds);
+
+    // what speculating on this tick saved against a plain Update
+    if (speculated) {
+        m_gain += (plainSeconds - seconds - m_startSeconds - m_gain) * GAIN_WEIGHT;
+        m_sinceProbe = 0;
+    } else if (m_sinceProbe < PROBE_TICKS) {
+        m_sinceProbe++;
+    }
+    m_stats.startSeconds += m_startSeconds;
+    m_startSeconds = 0.0;
+}
+
+Speculator::Stats Speculator::GetStats() const {
+    Stats s = m_stats;
+    s.startSeconds += m_startSeconds;
+    s.copies = m_copies;
+    s.savedSeconds = s.plainSeconds - s.hitSeconds - s.missSeconds - s.startSeconds;
+    return s;
+}
+
+void Speculator::RecordTick(uint64_t before, uint64_t after, Dir dir) {
+    // paused or not playing: nothing happened
+    if (after == before) return;
+    if (m_replayCount < MAX_REPLAY) m_replay[m_replayCount++] = dir;
+    else m_replayLost = true;
+}
+
+bool Speculator::CatchUp(int i) {
+    Game& branch = m_branches[i];
+    if (m_branchState[i] == BranchState::LOST) return false;
+
+    int next = 0;
+    if (m_branchState[i] == BranchState::TRIED) {
+        // the tried direction got played: that tick is done already
+        if (m_jobReplayCount > 0 && m_triedDir[i] == m_jobReplay[0]) next = 1;
+        else if (!branch.UndoUpdate()) return false;
+    }
+    for (; next < m_jobReplayCount; ++next) {
+        SteerTo(branch, m_jobReplay[next]);
+        branch.Update();
+    }
+    m_branchState[i] = BranchState::BASE;
+    return branch.GetTick() == m_baseTick && StateKey(branch) == m_baseKey;
+}
+
+void Speculator::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [this] { return m_stop || m_pending; });
+        if (m_stop) return;
+        m_pending = false;
+        lock.unlock();
+
+        // every branch must land on the state Start saw; the ones that
+        // can't are copied from one that did
+        int inStep = -1;
+        for (int i = 0; i < 3; ++i) {
+            if (CatchUp(i)) inStep = i;
+            else m_branchState[i] = BranchState::LOST;
+        }
+        for (int i = 0; i < 3 && inStep >= 0; ++i) {
+            if (m_branchState[i] != BranchState::LOST) continue;
+            m_branches[i].CopyStateFrom(m_branches[inStep]);
+            m_branchState[i] = BranchState::BASE;
+            m_copies++;
+        }
+
+        lock.lock();
+        if (inStep < 0) m_inStep = false;
+        for (int i = 0; i < 3 && inStep >= 0 && !m_cancel; ++i) {
+            m_running = i;
+            lock.unlock();
+
+            m_readers[i] = EventReader(m_streams[i]);
+            auto start = std::chrono::steady_clock::now();
+            m_branches[i].UpdateUndoable(m_branchDir[i]);
+            m_branchSeconds[i] = SecondsSince(start);
+
+            lock.lock();
+            m_branchState[i] = BranchState::TRIED;
+            m_triedDir[i] = m_branchDir[i];
+            m_running = -1;
+            m_done = i + 1;
+            m_branchDone.notify_all();
+        }
+        m_busy = false;
+        m_branchDone.notify_all();
+    }
+}
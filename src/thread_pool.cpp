@@ -0,0 +1,114 @@
+#include "thread_pool.h"
+
+// set while this thread runs ParallelFor items
+static thread_local bool t_inParallelFor = false;
+
+ThreadPool::ThreadPool(unsigned threads)
+    : m_fn(nullptr),
+      m_count(0),
+      m_next(0),
+      m_active(0),
+      m_job(0),
+      m_stop(false)
+{
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    // the caller of ParallelFor is one of the threads
+    for (unsigned i = 1; i < threads; ++i)
+        m_workers.emplace_back([this] { WorkerLoop(false); });
+    if (m_workers.empty()) m_taskThread = std::thread([this] { WorkerLoop(true); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& t : m_workers) t.join();
+    if (m_taskThread.joinable()) m_taskThread.join();
+}
+
+unsigned ThreadPool::Size() const {
+    return (unsigned)m_workers.size() + 1;
+}
+
+ThreadPool& ThreadPool::Shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) return;
+    if (m_workers.empty() || count == 1 || t_inParallelFor) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> run(m_runMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fn = &fn;
+        m_count = count;
+        m_next.store(0);
+        m_active = m_workers.size();
+        m_job++;
+    }
+    m_wake.notify_all();
+
+    RunItems();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_active == 0; });
+    m_fn = nullptr;
+}
+
+void ThreadPool::Submit(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(fn));
+    }
+    m_wake.notify_one();
+}
+
+void ThreadPool::RunItems() {
+    t_inParallelFor = true;
+    size_t i;
+    while ((i = m_next.fetch_add(1)) < m_count)
+        (*m_fn)(i);
+    t_inParallelFor = false;
+}
+
+void ThreadPool::WorkerLoop(bool tasksOnly) {
+    unsigned long seen = 0;
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] {
+                return m_stop || (!tasksOnly && m_job != seen) || !m_tasks.empty();
+            });
+            if (m_stop) return;
+            // a waiting ParallelFor goes first
+            if (tasksOnly || m_job == seen) {
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            seen = m_job;
+        }
+
+        if (task) {
+            // a task doesn't count as one of this pool's ParallelFor threads,
+            // so its own loops must not wait for them
+            t_inParallelFor = true;
+            task();
+            t_inParallelFor = false;
+            continue;
+        }
+
+        RunItems();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_active == 0) m_done.notify_one();
+    }
+}
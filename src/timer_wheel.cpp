@@ -0,0 +1,150 @@
+#include "timer_wheel.h"
+
+TimerWheel::TimerWheel(size_t capacity)
+    : m_heads(DUE + 1, -1),
+      m_freeHead(-1),
+      m_now(0),
+      m_pending(0)
+{
+    m_nodes.reserve(capacity);
+}
+
+TimerId TimerWheel::Schedule(uint64_t delay, int event, int arg) {
+    if (delay == 0) delay = 1;
+    const uint64_t maxDelay = (1ull << (SLOT_BITS * LEVELS)) - 1;
+    if (delay > maxDelay) delay = maxDelay;
+
+    int n;
+    if (m_freeHead >= 0) {
+        n = m_freeHead;
+        m_freeHead = m_nodes[n].next;
+    } else {
+        n = (int)m_nodes.size();
+        m_nodes.push_back(Node{0, 0, 0, 0, FREE, -1, -1});
+    }
+
+    Node& node = m_nodes[n];
+    node.expires = m_now + delay;
+    node.event = event;
+    node.arg = arg;
+    node.generation++;
+    Place(n);
+    m_pending++;
+
+    return ((uint64_t)node.generation << 32) | (uint32_t)(n + 1);
+}
+
+bool TimerWheel::Cancel(TimerId id) {
+    int n = Lookup(id);
+    if (n < 0) return false;
+    Unlink(n);
+    Release(n);
+    return true;
+}
+
+void TimerWheel::Clear() {
+    for (int n = 0; n < (int)m_nodes.size(); ++n) {
+        if (m_nodes[n].list != FREE) {
+            Unlink(n);
+            Release(n);
+        }
+    }
+}
+
+void TimerWheel::Reset(uint64_t now) {
+    Clear();
+    m_now = now;
+}
+
+int64_t TimerWheel::Remaining(TimerId id) const {
+    int n = Lookup(id);
+    if (n < 0) return -1;
+    return (int64_t)(m_nodes[n].expires - m_now);
+}
+
+int TimerWheel::Lookup(TimerId id) const {
+    int n = (int)(uint32_t)id - 1;
+    if (n < 0 || n >= (int)m_nodes.size()) return -1;
+    const Node& node = m_nodes[n];
+    if (node.list == FREE || node.generation != (uint32_t)(id >> 32)) return -1;
+    return n;
+}
+
+void TimerWheel::Tick() {
+    m_now++;
+
+    // when a level wraps, redistribute the next slot of the level above
+    // (highest level first so its timers can trickle all the way down)
+    int wrapped = 0;
+    while (wrapped + 1 < LEVELS &&
+           ((m_now >> (SLOT_BITS * (wrapped + 1))) << (SLOT_BITS * (wrapped + 1))) == m_now)
+        wrapped++;
+    for (int level = wrapped; level >= 1; --level)
+        Cascade(level);
+
+    // everything in the current level 0 slot expires now
+    int slot = (int)(m_now & (SLOTS - 1));
+    int n = m_heads[slot];
+    while (n >= 0) {
+        int next = m_nodes[n].next;
+        Unlink(n);
+        Link(n, DUE);
+        n = next;
+    }
+}
+
+int TimerWheel::PopDue() {
+    int n = m_heads[DUE];
+    if (n < 0) return -1;
+    Unlink(n);
+    Release(n);
+    return n;
+}
+
+void TimerWheel::Cascade(int level) {
+    int slot = level * SLOTS + (int)((m_now >> (SLOT_BITS * level)) & (SLOTS - 1));
+    int n = m_heads[slot];
+    while (n >= 0) {
+        int next = m_nodes[n].next;
+        Unlink(n);
+        Place(n);
+        n = next;
+    }
+}
+
+void TimerWheel::Place(int n) {
+    uint64_t expires = m_nodes[n].expires;
+    if (expires <= m_now) { Link(n, DUE); return; }
+
+    uint64_t delta = expires - m_now;
+    int level = 0;
+    while (level + 1 < LEVELS && delta >= (1ull << (SLOT_BITS * (level + 1))))
+        level++;
+    int slot = (int)((expires >> (SLOT_BITS * level)) & (SLOTS - 1));
+    Link(n, level * SLOTS + slot);
+}
+
+void TimerWheel::Link(int n, int list) {
+    Node& node = m_nodes[n];
+    node.list = list;
+    node.prev = -1;
+    node.next = m_heads[list];
+    if (node.next >= 0) m_nodes[node.next].prev = n;
+    m_heads[list] = n;
+}
+
+void TimerWheel::Unlink(int n) {
+    Node& node = m_nodes[n];
+    if (node.prev >= 0) m_nodes[node.prev].next = node.next;
+    else m_heads[node.list] = node.next;
+    if (node.next >= 0) m_nodes[node.next].prev = node.prev;
+    node.prev = node.next = -1;
+}
+
+void TimerWheel::Release(int n) {
+    Node& node = m_nodes[n];
+    node.list = FREE;
+    node.next = m_freeHead;
+    m_freeHead = n;
+    m_pending--;
+}
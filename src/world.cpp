@@ -0,0 +1,305 @@
+#include "world.h"
+#include "rng.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+// non-procedural boards up to this many chunks (1024x1024 cells) are
+// allocated up front, so playing on them never touches the heap
+static const size_t PRELOAD_MAX_CHUNKS = 256;
+
+// obstacle segments generated per procedural chunk
+static const int SEGMENTS_PER_CHUNK = 6;
+
+// cell changes a journal holds; a tick makes a handful, a level change
+// (which speculation doesn't undo anyway) thousands
+static const size_t MAX_JOURNAL = 1024;
+
+World::World(int cols, int rows)
+    : m_cols(cols),
+      m_rows(rows),
+      m_procedural(false),
+      m_seed(0),
+      m_clearMin{0, 0},
+      m_clearMax{-1, -1},
+      m_cacheKey(0),
+      m_cache(nullptr),
+      m_journaling(false),
+      m_journalFull(false)
+{
+    size_t chunksX = ((size_t)cols + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    size_t chunksY = ((size_t)rows + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    if (chunksX * chunksY <= PRELOAD_MAX_CHUNKS) {
+        m_chunks.reserve(chunksX * chunksY);
+        for (size_t cy = 0; cy < chunksY; ++cy)
+            for (size_t cx = 0; cx < chunksX; ++cx)
+                Load({(int)cx * CHUNK_SIZE, (int)cy * CHUNK_SIZE});
+    }
+}
+
+World::World(const World& other)
+    : m_cols(other.m_cols),
+      m_rows(other.m_rows),
+      m_procedural(other.m_procedural),
+      m_seed(other.m_seed),
+      m_clearMin(other.m_clearMin),
+      m_clearMax(other.m_clearMax),
+      m_chunks(other.m_chunks),
+      m_cacheKey(0),
+      m_cache(nullptr),
+      m_journaling(false),
+      m_journalFull(false)
+{
+}
+
+World& World::operator=(const World& other) {
+    if (this == &other) return *this;
+    m_cols = other.m_cols;
+    m_rows = other.m_rows;
+    m_procedural = other.m_procedural;
+    m_seed = other.m_seed;
+    m_clearMin = other.m_clearMin;
+    m_clearMax = other.m_clearMax;
+    m_chunks = other.m_chunks;
+    m_cache = nullptr;
+    // the journal is about this object's old state
+    m_journal.clear();
+    m_journaling = false;
+    m_journalFull = false;
+    return *this;
+}
+
+World::World(World&& other) noexcept
+    : m_cols(other.m_cols),
+      m_rows(other.m_rows),
+      m_procedural(other.m_procedural),
+      m_seed(other.m_seed),
+      m_clearMin(other.m_clearMin),
+      m_clearMax(other.m_clearMax),
+      m_chunks(std::move(other.m_chunks)),
+      m_cacheKey(other.m_cacheKey),
+      m_cache(other.m_cache),
+      m_journal(std::move(other.m_journal)),
+      m_journaling(other.m_journaling),
+      m_journalFull(other.m_journalFull)
+{
+    other.m_cache = nullptr;
+}
+
+World& World::operator=(World&& other) noexcept {
+    if (this == &other) return *this;
+    m_cols = other.m_cols;
+    m_rows = other.m_rows;
+    m_procedural = other.m_procedural;
+    m_seed = other.m_seed;
+    m_clearMin = other.m_clearMin;
+    m_clearMax = other.m_clearMax;
+    m_chunks = std::move(other.m_chunks);
+    m_cacheKey = other.m_cacheKey;
+    m_cache = other.m_cache;
+    other.m_cache = nullptr;
+    m_journal = std::move(other.m_journal);
+    m_journaling = other.m_journaling;
+    m_journalFull = other.m_journalFull;
+    return *this;
+}
+
+void World::EnableProcedural(uint64_t seed, Pos clearMin, Pos clearMax) {
+    m_procedural = true;
+    m_seed = seed;
+    m_clearMin = clearMin;
+    m_clearMax = clearMax;
+    m_chunks.clear();
+    m_cache = nullptr;
+}
+
+uint64_t World::Key(int cx, int cy) {
+    return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+}
+
+int World::Local(Pos p) {
+    return (p.y & (CHUNK_SIZE - 1)) * CHUNK_SIZE + (p.x & (CHUNK_SIZE - 1));
+}
+
+World::Chunk* World::Find(Pos p) {
+    uint64_t key = Key(p.x >> CHUNK_BITS, p.y >> CHUNK_BITS);
+    if (m_cache && m_cacheKey == key) return m_cache;
+    auto it = m_chunks.find(key);
+    if (it == m_chunks.end()) return nullptr;
+    m_cacheKey = key;
+    m_cache = &it->second;
+    return m_cache;
+}
+
+World::Chunk& World::Load(Pos p) {
+    if (Chunk* c = Find(p)) return *c;
+
+    int cx = p.x >> CHUNK_BITS;
+    int cy = p.y >> CHUNK_BITS;
+    Chunk& chunk = m_chunks[Key(cx, cy)];
+    memset(chunk.cells, 0, sizeof(chunk.cells));
+    chunk.dynamicCells = 0;
+    if (m_procedural) Generate(cx, cy, chunk);
+
+    m_cacheKey = Key(cx, cy);
+    m_cache = &chunk;
+    return chunk;
+}
+
+void World::Generate(int cx, int cy, Chunk& chunk) const {
+    Rng rng(m_seed ^ (Key(cx, cy) * 0xD1342543DE82EF95ull));
+    int originX = cx * CHUNK_SIZE;
+    int originY = cy * CHUNK_SIZE;
+
+    // short horizontal / vertical wall segments that stay inside the chunk
+    for (int i = 0; i < SEGMENTS_PER_CHUNK; ++i) {
+        uint64_t r = rng.Next();
+        int x = (int)(r % CHUNK_SIZE);
+        int y = (int)((r >> 8) % CHUNK_SIZE);
+        int length = 2 + (int)((r >> 16) % 5);
+        bool horizontal = ((r >> 24) & 1) != 0;
+
+        for (int k = 0; k < length; ++k) {
+            int lx = horizontal ? x + k : x;
+            int ly = horizontal ? y : y + k;
+            if (lx >= CHUNK_SIZE || ly >= CHUNK_SIZE) break;
+
+            int wx = originX + lx;
+            int wy = originY + ly;
+            if (wx >= m_cols || wy >= m_rows) continue;
+            if (wx >= m_clearMin.x && wx <= m_clearMax.x &&
+                wy >= m_clearMin.y && wy <= m_clearMax.y)
+                continue; // keep the spawn area free
+            chunk.cells[ly * CHUNK_SIZE + lx] |= CELL_OBSTACLE;
+        }
+    }
+}
+
+unsigned char World::Get(Pos p) {
+    if (m_procedural) return Load(p).cells[Local(p)];
+    Chunk* c = Find(p);
+    return c ? c->cells[Local(p)] : 0;
+}
+
+unsigned char World::Peek(Pos p) const {
+    auto it = m_chunks.find(Key(p.x >> CHUNK_BITS, p.y >> CHUNK_BITS));
+    return it == m_chunks.end() ? 0 : it->second.cells[Local(p)];
+}
+
+void World::PeekRow(int y, int x, int count, unsigned char* out) const {
+    while (count > 0) {
+        int n = std::min(count, CHUNK_SIZE - (x & (CHUNK_SIZE - 1)));
+        auto it = m_chunks.find(Key(x >> CHUNK_BITS, y >> CHUNK_BITS));
+        if (it == m_chunks.end()) memset(out, 0, n);
+        else memcpy(out, &it->second.cells[Local({x, y})], n);
+        out += n;
+        x += n;
+        count -= n;
+    }
+}
+
+void World::SetFlags(Pos p, unsigned char flags) {
+    Chunk& c = Load(p);
+    unsigned char& cell = c.cells[Local(p)];
+    if (m_journaling) Note(p, cell);
+    bool wasDynamic = (cell & ~CELL_OBSTACLE) != 0;
+    cell |= flags;
+    if (!wasDynamic && (cell & ~CELL_OBSTACLE) != 0) c.dynamicCells++;
+}
+
+void World::ClearFlags(Pos p, unsigned char flags) {
+    Chunk* c = Find(p);
+    if (!c) return;
+    unsigned char& cell = c->cells[Local(p)];
+    if (m_journaling) Note(p, cell);
+    bool wasDynamic = (cell & ~CELL_OBSTACLE) != 0;
+    cell &= ~flags;
+    if (wasDynamic && (cell & ~CELL_OBSTACLE) == 0) c->dynamicCells--;
+}
+
+void World::LoadAround(Pos center, int radius) {
+    if (!m_procedural) return;
+
+    int hx = center.x >> CHUNK_BITS;
+    int hy = center.y >> CHUNK_BITS;
+    int chunksX = (m_cols + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    int chunksY = (m_rows + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    // a board narrower than the radius would visit chunks twice; harmless
+    for (int dy = -radius; dy <= radius; ++dy) {
+        int cy = ((hy + dy) % chunksY + chunksY) % chunksY;
+        for (int dx = -radius; dx <= radius; ++dx) {
+            int cx = ((hx + dx) % chunksX + chunksX) % chunksX;
+            Load({cx << CHUNK_BITS, cy << CHUNK_BITS});
+        }
+    }
+}
+
+void World::EvictFar(Pos center, int radius) {
+    if (!m_procedural) return;
+
+    int hx = center.x >> CHUNK_BITS;
+    int hy = center.y >> CHUNK_BITS;
+    int chunksX = (m_cols + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    int chunksY = (m_rows + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    for (auto it = m_chunks.begin(); it != m_chunks.end(); ) {
+        int cx = (int)(it->first >> 32);
+        int cy = (int)(uint32_t)it->first;
+        // chunk distance on the wrapping board
+        int dx = cx > hx ? cx - hx : hx - cx;
+        int dy = cy > hy ? cy - hy : hy - cy;
+        if (chunksX - dx < dx) dx = chunksX - dx;
+        if (chunksY - dy < dy) dy = chunksY - dy;
+
+        if ((dx > radius || dy > radius) && it->second.dynamicCells == 0) {
+            if (m_cache == &it->second) m_cache = nullptr;
+            it = m_chunks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void World::Reset() {
+    m_cache = nullptr;
+    if (m_procedural) {
+        m_chunks.clear(); // obstacles regenerate on demand
+        return;
+    }
+    for (auto& entry : m_chunks) {
+        Chunk& c = entry.second;
+        if (c.dynamicCells == 0) continue;
+        for (auto& cell : c.cells) cell &= CELL_OBSTACLE;
+        c.dynamicCells = 0;
+    }
+}
+
+void World::StartJournal() {
+    if (m_journal.capacity() < MAX_JOURNAL) m_journal.reserve(MAX_JOURNAL);
+    m_journal.clear();
+    m_journaling = true;
+    m_journalFull = false;
+}
+
+bool World::StopJournal() {
+    m_journaling = false;
+    return !m_journalFull;
+}
+
+void World::Note(Pos p, unsigned char flags) {
+    if (m_journal.size() == MAX_JOURNAL) { m_journalFull = true; return; }
+    m_journal.push_back(JournalEntry{p, flags});
+}
+
+void World::RollBack() {
+    // newest first, so a cell changed twice ends up with its oldest flags
+    for (size_t i = m_journal.size(); i-- > 0; ) {
+        Pos p = m_journal[i].pos;
+        Chunk& c = Load(p);
+        unsigned char& cell = c.cells[Local(p)];
+        bool wasDynamic = (cell & ~CELL_OBSTACLE) != 0;
+        cell = m_journal[i].flags;
+        c.dynamicCells += (int)((cell & ~CELL_OBSTACLE) != 0) - (int)wasDynamic;
+    }
+    m_journal.clear();
+}
@@ -0,0 +1,39 @@
+#include "zobrist.h"
+
+namespace {
+
+// one salt per key family so equal coordinates hash differently
+const uint64_t SALT_SNAKE    = 0x9E3779B97F4A7C15ull;
+const uint64_t SALT_HEAD     = 0xC2B2AE3D27D4EB4Full;
+const uint64_t SALT_OBSTACLE = 0x165667B19E3779F9ull;
+const uint64_t SALT_DIR      = 0xD6E8FEB86659FD93ull;
+const uint64_t SALT_FOOD     = 0xFF51AFD7ED558CCDull;
+const uint64_t SALT_HIDDEN   = 0xC4CEB9FE1A85EC53ull;
+const uint64_t SALT_WORLD    = 0x2545F4914F6CDD1Dull;
+
+// splitmix64 finalizer
+uint64_t Mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+uint64_t CellKey(Pos p) {
+    return (uint64_t)(uint32_t)p.x | ((uint64_t)(uint32_t)p.y << 32);
+}
+
+} // namespace
+
+uint64_t Zobrist::SnakeCell(Pos p) { return Mix(CellKey(p) ^ SALT_SNAKE); }
+uint64_t Zobrist::SnakeHead(Pos p) { return Mix(CellKey(p) ^ SALT_HEAD); }
+uint64_t Zobrist::Obstacle(Pos p)  { return Mix(CellKey(p) ^ SALT_OBSTACLE); }
+uint64_t Zobrist::Direction(int dir) { return Mix((uint64_t)dir ^ SALT_DIR); }
+uint64_t Zobrist::WorldSeed(uint64_t seed) { return Mix(seed ^ SALT_WORLD); }
+
+uint64_t Zobrist::Food(int slot, Pos p) {
+    return Mix(Mix(CellKey(p) ^ SALT_FOOD) + (uint64_t)slot);
+}
+
+uint64_t Zobrist::HiddenFood(int slot) {
+    return Mix((uint64_t)slot ^ SALT_HIDDEN);
+}
@@ -0,0 +1,88 @@
+// tests/alloc_free_ticks.cpp
+// Counts heap allocations with a replaced global operator new and fails if
+// Game::Update allocates once Restart has run. Bot games play through every
+// level change (a short pointsPerLevel gets them past the generated levels)
+// on the hand-coded board, a fully generated board and, if given, a pack.
+// The bot outplays the background level builds, so they are finished first,
+// as they would be after a level or two of real play.
+//   alloc_free_ticks [levels.pak]
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include "bot.h"
+#include "game.h"
+
+static const int GAMES = 200;
+static const uint64_t MAX_TICKS = 5000;
+
+// only the game thread counts; the pool builds levels in the background
+static thread_local bool g_counting = false;
+static std::atomic<uint64_t> g_allocations(0);
+
+void* operator new(size_t size) {
+    if (g_counting) g_allocations++;
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    if (g_counting) g_allocations++;
+    return malloc(size ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// plays the games and returns false (after printing why) if a tick allocated
+static bool Run(const char* name, int cols, int rows, const std::string& pack) {
+    Game game(cols, rows);
+    game.SetHighScoreFile("");
+    if (!pack.empty()) {
+        std::string error;
+        if (!game.LoadLevelPack(pack, &error)) {
+            fprintf(stderr, "alloc_free_ticks: %s\n", error.c_str());
+            return false;
+        }
+    }
+    DifficultyConfig difficulty;
+    difficulty.pointsPerLevel = 20;
+    game.SetDifficulty(difficulty);
+    game.FinishGeneratedLevels();
+    Bot bot(7);
+
+    uint64_t ticks = 0, allocations = 0;
+    int topLevel = 0;
+    for (int g = 0; g < GAMES; ++g) {
+        game.SetSeed(g + 1);
+        game.StartGame();
+        for (uint64_t t = 0; t < MAX_TICKS && !game.IsGameOver(); ++t) {
+            game.SetDirection(bot.Choose(game));
+            g_allocations = 0;
+            g_counting = true;
+            game.Update();
+            g_counting = false;
+            allocations += g_allocations;
+            ticks++;
+        }
+        if (game.GetLevel() > topLevel) topLevel = game.GetLevel();
+    }
+
+    printf("%s %dx%d: %llu ticks up to level %d, %llu allocations\n", name, cols, rows,
+           (unsigned long long)ticks, topLevel, (unsigned long long)allocations);
+    return allocations == 0;
+}
+
+int main(int argc, char** argv) {
+    bool ok = Run("hand-coded", 20, 20, "");
+    ok = Run("generated", 48, 32, "") && ok;
+    if (argc > 1) ok = Run("level pack", 20, 20, argv[1]) && ok;
+    if (!ok) {
+        fprintf(stderr, "alloc_free_ticks: Update allocated after Restart\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,19 @@
+// tools/levelpack.cpp
+// Compiles a text level source (see levels/default.txt) into a binary pack.
+#include <cstdio>
+#include <string>
+#include "level_pack.h"
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: levelpack <source.txt> <output.pak>\n");
+        return 2;
+    }
+
+    std::string error;
+    if (!LevelPack::Compile(argv[1], argv[2], error)) {
+        fprintf(stderr, "levelpack: %s\n", error.c_str());
+        return 1;
+    }
+    return 0;
+}
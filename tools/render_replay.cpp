@@ -0,0 +1,158 @@
+// tools/render_replay.cpp
+// Plays a recorded run (see include/replay.h) without a window and streams
+// it as video: raw Y4M (ffmpeg, mpv and x264 read it directly) or a stream
+// of binary PPM frames. The game runs on the calling thread; frames are
+// captured in batches, rendered and converted on all cores, then written in
+// order.
+//   render_replay last.replay - | ffmpeg -i - run.mp4
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "game.h"
+#include "replay.h"
+#include "soft_renderer.h"
+#include "thread_pool.h"
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+// frames captured, then rendered in parallel, per round
+static const size_t BATCH = 64;
+// how long the last frame stays on screen (time-based output only)
+static const double HOLD_SECONDS = 1.0;
+
+static const char* LEVEL_PACK_FILE = "levels.pak";
+static const char* DIFFICULTY_FILE = "difficulty.cfg";
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: render_replay <replay> [out.y4m|out.ppm|-] [y4m|ppm] [fps, 0 = one frame per tick]\n");
+        return 2;
+    }
+    std::string outPath = argc > 2 ? argv[2] : "-";
+    std::string format = argc > 3 ? argv[3] : "y4m";
+    int fps = argc > 4 ? atoi(argv[4]) : 60;
+    if ((format != "y4m" && format != "ppm") || fps < 0) {
+        fprintf(stderr, "render_replay: format must be y4m or ppm and fps >= 0\n");
+        return 2;
+    }
+    const bool y4m = format == "y4m";
+
+    Replay replay;
+    std::string error;
+    if (!replay.Load(argv[1], error)) {
+        fprintf(stderr, "render_replay: %s\n", error.c_str());
+        return 1;
+    }
+
+    // same rules as the recorded game: level pack and difficulty from the
+    // working directory
+    Game game(replay.Cols(), replay.Rows(), 2);
+    game.SetHighScoreFile("");
+    if (std::ifstream(DIFFICULTY_FILE).good()) {
+        DifficultyConfig difficulty;
+        if (difficulty.Load(DIFFICULTY_FILE, error)) game.SetDifficulty(difficulty);
+        else fprintf(stderr, "render_replay: difficulty config ignored: %s\n", error.c_str());
+    }
+    game.LoadLevelPack(LEVEL_PACK_FILE);
+    if (!replay.CheckRules(game, error)) {
+        fprintf(stderr, "render_replay: %s: %s (%s, %s)\n", argv[1], error.c_str(),
+                LEVEL_PACK_FILE, DIFFICULTY_FILE);
+        return 1;
+    }
+    replay.Start(game);
+
+    FILE* out = stdout;
+    if (outPath != "-") {
+        out = fopen(outPath.c_str(), "wb");
+        if (!out) {
+            fprintf(stderr, "render_replay: %s: cannot write\n", outPath.c_str());
+            return 1;
+        }
+    }
+#ifdef _WIN32
+    else {
+        _setmode(_fileno(stdout), _O_BINARY);
+    }
+#endif
+
+    if (y4m) {
+        fprintf(out, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n",
+                SoftRenderer::WIDTH, SoftRenderer::HEIGHT, fps > 0 ? fps : 60);
+    }
+    char ppmHeader[32];
+    int ppmHeaderSize = snprintf(ppmHeader, sizeof(ppmHeader), "P6\n%d %d\n255\n",
+                                 SoftRenderer::WIDTH, SoftRenderer::HEIGHT);
+    const size_t frameSize = y4m ? SoftRenderer::I420_SIZE : SoftRenderer::RGB_SIZE;
+
+    std::vector<FrameState> frames(BATCH);
+    std::vector<uint8_t> encoded(BATCH * frameSize);
+    ThreadPool& pool = ThreadPool::Shared();
+
+    // time-based output: frame n shows the game at n/fps seconds, with ticks
+    // spaced by the game's speed at the time, like the game loop
+    size_t tick = 0;
+    double now = 0.0, nextTick = game.GetSpeed();
+    size_t holdFrames = fps > 0 ? (size_t)(HOLD_SECONDS * fps) : 0;
+    uint64_t frameCount = 0;
+    double renderSeconds = 0.0;
+    auto start = std::chrono::steady_clock::now();
+
+    bool done = false;
+    while (!done) {
+        size_t count = 0;
+        while (count < BATCH && !done) {
+            int best = std::max(replay.HighScore(), game.GetHighScore());
+            frames[count++].Capture(game, best);
+
+            if (fps == 0) {
+                if (tick < replay.Ticks()) replay.Step(game, tick++);
+                else done = true;
+                continue;
+            }
+            now += 1.0 / fps;
+            while (tick < replay.Ticks() && nextTick <= now) {
+                replay.Step(game, tick++);
+                nextTick += game.GetSpeed();
+            }
+            if (tick == replay.Ticks() && holdFrames-- == 0) done = true;
+        }
+
+        auto renderStart = std::chrono::steady_clock::now();
+        FrameState* batch = frames.data();
+        uint8_t* dst = encoded.data();
+        pool.ParallelFor(count, [batch, dst, frameSize, y4m](size_t i) {
+            static thread_local std::vector<uint8_t> pixels(SoftRenderer::PIXELS_SIZE);
+            SoftRenderer::Render(batch[i], pixels.data());
+            if (y4m) SoftRenderer::ToI420(pixels.data(), dst + i * frameSize);
+            else SoftRenderer::ToRgb(pixels.data(), dst + i * frameSize);
+        });
+        renderSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - renderStart).count();
+
+        for (size_t i = 0; i < count; ++i) {
+            if (y4m) fputs("FRAME\n", out);
+            else fwrite(ppmHeader, 1, ppmHeaderSize, out);
+            fwrite(dst + i * frameSize, 1, frameSize, out);
+        }
+        frameCount += count;
+    }
+
+    bool ok = fflush(out) == 0 && !ferror(out);
+    if (out != stdout) ok = fclose(out) == 0 && ok;
+    if (!ok) {
+        fprintf(stderr, "render_replay: %s: write failed\n", outPath.c_str());
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fprintf(stderr, "%llu frames (%zu ticks, score %d) in %.2f s: %.0f fps rendered on %u threads, %.0f fps overall\n",
+            (unsigned long long)frameCount, replay.Ticks(), game.GetScore(), seconds,
+            renderSeconds > 0 ? frameCount / renderSeconds : 0.0, pool.Size(),
+            seconds > 0 ? frameCount / seconds : 0.0);
+    return 0;
+}
@@ -0,0 +1,99 @@
+// tools/simulate.cpp
+// Plays many headless bot games in parallel and writes death heatmaps and
+// survival curves. Per-thread DeathStats are merged by a parallel reduction,
+// so memory stays constant however many games are played.
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bot.h"
+#include "death_stats.h"
+#include "game.h"
+#include "thread_pool.h"
+
+// games a worker claims at a time
+static const uint64_t CLAIM = 64;
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: simulate <games> [cols rows] [max ticks] [output prefix] [seed]\n");
+        return 2;
+    }
+    uint64_t games = strtoull(argv[1], nullptr, 10);
+    int cols = argc > 3 ? atoi(argv[2]) : 20;
+    int rows = argc > 3 ? atoi(argv[3]) : 20;
+    uint64_t maxTicks = argc > 4 ? strtoull(argv[4], nullptr, 10) : 20000;
+    std::string prefix = argc > 5 ? argv[5] : "sim";
+    uint64_t seed = argc > 6 ? strtoull(argv[6], nullptr, 10) : 1;
+    if (games == 0 || cols < 8 || rows < 8) {
+        fprintf(stderr, "simulate: need at least one game on a board of 8x8 or more\n");
+        return 2;
+    }
+
+    ThreadPool& pool = ThreadPool::Shared();
+    unsigned workers = pool.Size();
+    std::vector<std::unique_ptr<DeathStats>> stats(workers);
+    std::atomic<uint64_t> next(0);
+
+    auto start = std::chrono::steady_clock::now();
+
+    // one item per thread; each keeps its own Game (so generated levels are
+    // cached across games) and its own histograms
+    pool.ParallelFor(workers, [&](size_t w) {
+        stats[w].reset(new DeathStats(cols, rows));
+        Game game(cols, rows);
+        game.SetHighScoreFile("");
+
+        uint64_t first;
+        while ((first = next.fetch_add(CLAIM)) < games) {
+            uint64_t last = std::min(games, first + CLAIM);
+            for (uint64_t g = first; g < last; ++g) {
+                // per-game seeds: results don't depend on the thread count
+                game.SetSeed(seed * 0x9E3779B97F4A7C15ull + g);
+                Bot bot(seed ^ (g * 0xD1342543DE82EF95ull));
+                game.StartGame();
+
+                uint64_t ticks = 0;
+                while (!game.IsGameOver() && ticks < maxTicks) {
+                    game.SetDirection(bot.Choose(game));
+                    game.Update();
+                    ticks++;
+                }
+                if (game.IsGameOver()) stats[w]->AddDeath(game, ticks);
+                else stats[w]->AddSurvivor(game, ticks);
+            }
+        }
+    });
+
+    // pairwise reduction: log2(workers) rounds of parallel merges
+    for (size_t stride = 1; stride < workers; stride *= 2) {
+        size_t pairs = (workers + 2 * stride - 1) / (2 * stride);
+        pool.ParallelFor(pairs, [&](size_t i) {
+            size_t a = i * 2 * stride, b = a + stride;
+            if (b < workers) stats[a]->Merge(*stats[b]);
+        });
+    }
+    const DeathStats& total = *stats[0];
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%llu games on %dx%d in %.2f s (%u threads): %llu self, %llu obstacle, %llu reached %llu ticks\n",
+           (unsigned long long)total.Games(), cols, rows, seconds, workers,
+           (unsigned long long)total.Deaths(DeathCause::SELF),
+           (unsigned long long)total.Deaths(DeathCause::OBSTACLE),
+           (unsigned long long)(total.Games() - total.Deaths()), (unsigned long long)maxTicks);
+
+    std::string error;
+    bool ok = total.WriteHeatmap(prefix + "_deaths.pgm", error) &&
+              total.WriteSurvivalCsv(prefix + "_survival.csv", error) &&
+              total.WriteLevelCsv(prefix + "_levels.csv", error);
+    for (int level = 1; ok && level <= total.MaxLevel(); ++level)
+        ok = total.WriteLevelHeatmap(prefix + "_level" + std::to_string(level) + ".ppm", level, error);
+    if (!ok) {
+        fprintf(stderr, "simulate: %s\n", error.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+// tools/speculate.cpp
+// Plays bot games through a Speculator on a fixed tick interval, the way
+// the game window does, and reports how often the precomputed tick was
+// used and the net latency: Tick plus Start against the plain Update of a
+// second game fed the same inputs, which must end every tick in the same
+// state.
+//   speculate 200 200 20000 2000
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include "bot.h"
+#include "game.h"
+#include "speculator.h"
+
+// frames drawn between two ticks
+static const int FRAMES_PER_TICK = 4;
+
+int main(int argc, char** argv) {
+    int cols = argc > 2 ? atoi(argv[1]) : 20;
+    int rows = argc > 2 ? atoi(argv[2]) : 20;
+    uint64_t ticks = argc > 3 ? strtoull(argv[3], nullptr, 10) : 5000;
+    int intervalUs = argc > 4 ? atoi(argv[4]) : 1000;
+    uint64_t seed = argc > 5 ? strtoull(argv[5], nullptr, 10) : 1;
+    if (cols < 8 || rows < 8 || ticks == 0 || intervalUs < 0) {
+        fprintf(stderr, "usage: speculate [cols rows] [ticks] [tick interval us] [seed]\n");
+        return 2;
+    }
+
+    Game game(cols, rows);
+    Game plain(cols, rows);
+    game.SetHighScoreFile("");
+    plain.SetHighScoreFile("");
+    Speculator speculator(game);
+    Bot bot(seed);
+
+    uint64_t games = 0, mismatches = 0;
+    double plainSeconds = 0.0, worstPlainSeconds = 0.0;
+    for (uint64_t t = 0; t < ticks; ++t) {
+        if (game.GetState() != GameState::PLAYING) {
+            game.SetSeed(seed + games);
+            plain.SetSeed(seed + games);
+            game.StartGame();
+            plain.StartGame();
+            games++;
+        }
+
+        // the player thinks while the worker runs ahead; like the game
+        // window, Start is retried every frame while the worker is still
+        // finishing an earlier job
+        for (int frame = 0; frame < FRAMES_PER_TICK; ++frame) {
+            if (!speculator.IsCurrent(game)) speculator.Start(game);
+            std::this_thread::sleep_for(std::chrono::microseconds(intervalUs / FRAMES_PER_TICK));
+        }
+
+        Dir d = bot.Choose(game);
+        game.SetDirection(d);
+        plain.SetDirection(d);
+        // whichever goes second finds the caches warm, so take turns
+        if (t % 2) speculator.Tick(game);
+        auto start = std::chrono::steady_clock::now();
+        plain.Update();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        plainSeconds += seconds;
+        worstPlainSeconds = std::max(worstPlainSeconds, seconds);
+        if (t % 2 == 0) speculator.Tick(game);
+
+        if (game.GetStateHash() != plain.GetStateHash() || game.GetScore() != plain.GetScore() ||
+            game.GetState() != plain.GetState())
+            mismatches++;
+    }
+
+    Speculator::Stats s = speculator.GetStats();
+    uint64_t others = s.ticks - s.hits;
+    double hitUs = s.hits ? s.hitSeconds / s.hits * 1e6 : 0.0;
+    double otherUs = others ? s.missSeconds / others * 1e6 : 0.0;
+    double specUs = (s.hitSeconds + s.missSeconds + s.startSeconds) / s.ticks * 1e6;
+    double plainUs = plainSeconds / s.ticks * 1e6;
+    printf("%llu ticks (%llu games) on %dx%d: %llu hits (%.1f%%), %llu late, %llu missed, %llu skipped\n",
+           (unsigned long long)s.ticks, (unsigned long long)games, cols, rows,
+           (unsigned long long)s.hits, 100.0 * s.hits / s.ticks, (unsigned long long)s.late,
+           (unsigned long long)s.missed, (unsigned long long)s.skipped);
+    printf("tick latency: %.2f us on hits, %.2f us otherwise; Start %.2f us per tick "
+           "(%llu copies of the game, %llu on the worker)\n",
+           hitUs, otherUs, s.startSeconds / s.ticks * 1e6,
+           (unsigned long long)s.resyncs, (unsigned long long)s.copies);
+    printf("Tick + Start %.2f us per tick against %.2f us for plain Update: net %.2f us saved per tick\n",
+           specUs, plainUs, plainUs - specUs);
+    printf("worst tick %.2f us, worst plain Update %.2f us\n",
+           s.worstTickSeconds * 1e6, worstPlainSeconds * 1e6);
+    if (mismatches) {
+        fprintf(stderr, "speculate: %llu ticks differ from plain Update\n", (unsigned long long)mismatches);
+        return 1;
+    }
+    return 0;
+}
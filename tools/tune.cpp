@@ -0,0 +1,391 @@
+// tools/tune.cpp
+// Searches difficulty settings (level thresholds, speed curve and food
+// values) with an evolutionary search over bot simulations, and writes the
+// best one as a config the game loads at startup (difficulty.cfg).
+//
+// The bot stands in for a human: its chance of a wrong move per step grows
+// as steps get shorter. Each candidate is scored against per-level targets
+// for the chance of dying on the level and the seconds spent on it.
+// Candidates live on a fixed grid. Results are cached by grid point in
+// tune_cache.txt, so a point is never simulated twice across generations or
+// runs. All uncached points of a generation are simulated as one batch on
+// the thread pool. Like the game, it plays levels.pak if there is one.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "bot.h"
+#include "difficulty.h"
+#include "game.h"
+#include "rng.h"
+#include "thread_pool.h"
+
+// levels scored; games reaching the level after this stop there
+static const int TUNE_LEVELS = 10;
+static const uint64_t MAX_TICKS = 20000;
+static const int GAMES_PER_ITEM = 32;
+static const int POPULATION = 24;
+static const int ELITE = 6;
+static const char* CACHE_FILE = "tune_cache.txt";
+// the level pack the game loads
+static const char* DEFAULT_PACK_FILE = "levels.pak";
+
+// human model: wrong moves per step at the reference tick, growing with
+// the cube of the speed-up
+static const float MISTAKE_RATE = 0.002f;
+static const float REFERENCE_TICK = 0.12f;
+
+// search grid: value = min + index * step
+struct Gene {
+    float min, step;
+    int count;
+};
+// bonus_every stays at its default: it only matters together with the
+// bonus food value, which is searched
+static const int GENE_COUNT = 8;
+static const Gene GENES[GENE_COUNT] = {
+    {20.0f, 10.0f, 39},     // points_per_level 20 .. 400
+    {0.08f, 0.005f, 33},    // base_tick 0.08 .. 0.24
+    {0.0f,  0.0025f, 13},   // tick_step 0 .. 0.03
+    {0.03f, 0.005f, 15},    // min_tick 0.03 .. 0.10
+    {5.0f,  1.0f, 26},      // food 5 .. 30
+    {5.0f,  1.0f, 36},      // bonus_food 5 .. 40
+    {-30.0f, 1.0f, 31},     // poison -30 .. 0
+    {0.0f,  5.0f, 13},      // level_bonus_food 0 .. 60
+};
+
+struct Point {
+    int g[GENE_COUNT];
+
+    // 8 bits per gene; every count fits
+    uint64_t Key() const {
+        uint64_t key = 0;
+        for (int i = 0; i < GENE_COUNT; ++i) key |= (uint64_t)g[i] << (8 * i);
+        return key;
+    }
+
+    int Value(int i) const { return (int)std::lround(GENES[i].min + g[i] * GENES[i].step); }
+
+    DifficultyConfig Config() const {
+        DifficultyConfig cfg;
+        cfg.pointsPerLevel = Value(0);
+        cfg.baseTick = GENES[1].min + g[1] * GENES[1].step;
+        cfg.tickStep = GENES[2].min + g[2] * GENES[2].step;
+        cfg.minTick = GENES[3].min + g[3] * GENES[3].step;
+        cfg.foodValue = Value(4);
+        cfg.bonusFoodValue = Value(5);
+        cfg.poisonValue = Value(6);
+        cfg.levelBonusFood = Value(7);
+        return cfg;
+    }
+};
+
+// per-level totals of a batch of games
+struct Metrics {
+    uint64_t reached[TUNE_LEVELS];
+    uint64_t died[TUNE_LEVELS];
+    double seconds[TUNE_LEVELS];
+
+    Metrics() {
+        std::fill(reached, reached + TUNE_LEVELS, 0);
+        std::fill(died, died + TUNE_LEVELS, 0);
+        std::fill(seconds, seconds + TUNE_LEVELS, 0.0);
+    }
+
+    void Add(const Metrics& o) {
+        for (int l = 0; l < TUNE_LEVELS; ++l) {
+            reached[l] += o.reached[l];
+            died[l] += o.died[l];
+            seconds[l] += o.seconds[l];
+        }
+    }
+};
+
+struct Target {
+    double deathRate;  // chance of dying on the level once reached
+    double seconds;    // mean seconds spent on the level
+};
+
+static float HumanMistakeRate(float tickSeconds) {
+    float r = REFERENCE_TICK / tickSeconds;
+    return std::min(0.5f, MISTAKE_RATE * r * r * r);
+}
+
+// play `count` games on the default 20x20 board, starting at game index `first`
+static Metrics Simulate(const DifficultyConfig& cfg, const std::string& packPath,
+                        uint64_t first, int count) {
+    Metrics m;
+    Game game(20, 20);
+    game.SetHighScoreFile("");
+    if (!packPath.empty()) game.LoadLevelPack(packPath);
+    game.SetDifficulty(cfg);
+
+    for (uint64_t g = first; g < first + count; ++g) {
+        game.SetSeed(g * 0x9E3779B97F4A7C15ull + 1);
+        Bot bot(g ^ 0xB07B07B07ull);
+        game.StartGame();
+
+        int level = game.GetLevel();
+        m.reached[0]++;
+        uint64_t ticks = 0;
+        while (!game.IsGameOver() && ticks < MAX_TICKS) {
+            bot.SetMistakeRate(HumanMistakeRate(game.GetSpeed()));
+            game.SetDirection(bot.Choose(game));
+            float tick = game.GetSpeed();
+            game.Update();
+            ticks++;
+
+            m.seconds[level - 1] += tick;
+            if (game.GetLevel() != level) {
+                level = game.GetLevel();
+                if (level > TUNE_LEVELS) break;
+                m.reached[level - 1]++;
+            }
+        }
+        if (game.IsGameOver() && level <= TUNE_LEVELS) m.died[level - 1]++;
+    }
+    return m;
+}
+
+static double Score(const Metrics& m, const std::vector<Target>& targets) {
+    double score = 0.0;
+    for (int l = 0; l < TUNE_LEVELS; ++l) {
+        const Target& t = targets[l];
+        // too few games got this far to measure: count as a full miss
+        if (m.reached[l] < 8) { score += 4.0; continue; }
+        double deathRate = (double)m.died[l] / m.reached[l];
+        double seconds = m.seconds[l] / m.reached[l];
+        double d = (deathRate - t.deathRate) / 0.1;
+        double s = std::log(std::max(seconds, 0.1) / t.seconds);
+        score += d * d + s * s;
+    }
+    return score;
+}
+
+// defaults: 20 s per level, dying gets likelier from 5% to 40%
+static std::vector<Target> DefaultTargets() {
+    std::vector<Target> targets;
+    for (int l = 0; l < TUNE_LEVELS; ++l)
+        targets.push_back({0.05 + 0.35 * l / (TUNE_LEVELS - 1), 20.0});
+    return targets;
+}
+
+// lines: level <n> death_rate <p> seconds <s>
+static bool LoadTargets(const std::string& path, std::vector<Target>& targets, std::string& error) {
+    std::ifstream in(path);
+    if (!in) { error = path + ": cannot open"; return false; }
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        std::istringstream ls(line);
+        std::string key, k1, k2;
+        int level;
+        Target t;
+        if (!(ls >> key) || key[0] == '#') continue;
+        if (key != "level" || !(ls >> level >> k1 >> t.deathRate >> k2 >> t.seconds) ||
+            k1 != "death_rate" || k2 != "seconds" || level < 1 || level > TUNE_LEVELS || t.seconds <= 0) {
+            error = path + ":" + std::to_string(lineNo) + ": expected 'level <1-" +
+                    std::to_string(TUNE_LEVELS) + "> death_rate <p> seconds <s>'";
+            return false;
+        }
+        targets[level - 1] = t;
+    }
+    return true;
+}
+
+// FNV-1a of the pack file, 0 without a pack
+static bool PackChecksum(const std::string& path, uint64_t& checksum, std::string& error) {
+    checksum = 0;
+    if (path.empty()) return true;
+    std::ifstream in(path, std::ios::binary);
+    if (!in) { error = path + ": cannot open"; return false; }
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    checksum = 0xCBF29CE484222325ull;
+    for (unsigned char c : data) {
+        checksum ^= c;
+        checksum *= 0x100000001B3ull;
+    }
+    return true;
+}
+
+// cache lines: key, then reached/died/seconds per level. The first line
+// names the games per point and the pack contents, since results depend on
+// both; a pack rebuilt with other levels invalidates the cache even under
+// the same path.
+static std::string CacheTag(int games, uint64_t packChecksum) {
+    char sum[17];
+    snprintf(sum, sizeof(sum), "%016llx", (unsigned long long)packChecksum);
+    return "tune-cache v3 games " + std::to_string(games) + " pack " + (packChecksum ? sum : "-");
+}
+
+static void LoadCache(std::unordered_map<uint64_t, Metrics>& cache, const std::string& tag) {
+    std::ifstream in(CACHE_FILE);
+    std::string line;
+    if (!std::getline(in, line) || line != tag) return;
+    while (std::getline(in, line)) {
+        std::istringstream ls(line);
+        uint64_t key;
+        Metrics m;
+        if (!(ls >> key)) continue;
+        bool ok = true;
+        for (int l = 0; l < TUNE_LEVELS && ok; ++l)
+            ok = (bool)(ls >> m.reached[l] >> m.died[l] >> m.seconds[l]);
+        if (ok) cache[key] = m;
+    }
+}
+
+static void AppendCache(const std::vector<std::pair<uint64_t, Metrics>>& entries, const std::string& tag,
+                        bool fresh) {
+    std::ofstream out(CACHE_FILE, fresh ? std::ios::trunc : std::ios::app);
+    if (!out) return;
+    if (fresh) out << tag << "\n";
+    for (const auto& e : entries) {
+        out << e.first;
+        for (int l = 0; l < TUNE_LEVELS; ++l)
+            out << " " << e.second.reached[l] << " " << e.second.died[l] << " " << e.second.seconds[l];
+        out << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    int games = argc > 1 ? atoi(argv[1]) : 512;
+    int generations = argc > 2 ? atoi(argv[2]) : 20;
+    std::string outPath = argc > 3 ? argv[3] : "difficulty.cfg";
+    std::string packPath = argc > 4 ? argv[4] : DEFAULT_PACK_FILE;
+    if (packPath == "-") packPath.clear();
+    std::string targetsPath = argc > 5 ? argv[5] : "";
+    if (games < GAMES_PER_ITEM || generations < 1) {
+        fprintf(stderr, "usage: tune [games per point >= %d] [generations] [output.cfg] [levels.pak|-] [targets.txt]\n",
+                GAMES_PER_ITEM);
+        return 2;
+    }
+    games -= games % GAMES_PER_ITEM;
+
+    std::string error;
+    std::vector<Target> targets = DefaultTargets();
+    if (!targetsPath.empty() && !LoadTargets(targetsPath, targets, error)) {
+        fprintf(stderr, "tune: %s\n", error.c_str());
+        return 1;
+    }
+    LevelPack pack;
+    if (!packPath.empty() && !pack.Load(packPath, &error)) {
+        // the game plays without a pack too; only a named one must load
+        if (argc > 4) {
+            fprintf(stderr, "tune: %s\n", error.c_str());
+            return 1;
+        }
+        printf("tune: no %s, tuning the built-in levels\n", packPath.c_str());
+        packPath.clear();
+    }
+    if (pack.IsLoaded() && (pack.Cols() != 20 || pack.Rows() != 20)) {
+        fprintf(stderr, "tune: %s: pack is not for the 20x20 board\n", packPath.c_str());
+        return 1;
+    }
+    uint64_t packChecksum;
+    if (!PackChecksum(packPath, packChecksum, error)) {
+        fprintf(stderr, "tune: %s\n", error.c_str());
+        return 1;
+    }
+
+    const std::string tag = CacheTag(games, packChecksum);
+    std::unordered_map<uint64_t, Metrics> cache;
+    LoadCache(cache, tag);
+    bool freshCache = cache.empty();
+    printf("tune: %d games per point, %zu cached points\n", games, cache.size());
+
+    // start from the built-in values plus random points
+    Rng rng(0x7E57);
+    std::vector<Point> population;
+    population.push_back(Point{{3, 8, 4, 0, 5, 10, 20, 4}});  // 50, 0.12, 0.01, 0.03, 10, 15, -10, 20
+    while ((int)population.size() < POPULATION) {
+        Point p;
+        for (int i = 0; i < GENE_COUNT; ++i) p.g[i] = rng.Below(GENES[i].count);
+        population.push_back(p);
+    }
+
+    ThreadPool& pool = ThreadPool::Shared();
+    Point best = population[0];
+    double bestScore = 1e30;
+
+    for (int gen = 0; gen < generations; ++gen) {
+        auto start = std::chrono::steady_clock::now();
+
+        // batch every point of this generation that isn't cached yet
+        std::vector<Point> pending;
+        for (const auto& p : population) {
+            bool queued = false;
+            for (const auto& q : pending) queued = queued || q.Key() == p.Key();
+            if (!queued && !cache.count(p.Key())) pending.push_back(p);
+        }
+
+        const int itemsPerPoint = games / GAMES_PER_ITEM;
+        std::vector<Metrics> items(pending.size() * itemsPerPoint);
+        pool.ParallelFor(items.size(), [&](size_t i) {
+            const Point& p = pending[i / itemsPerPoint];
+            uint64_t first = (uint64_t)(i % itemsPerPoint) * GAMES_PER_ITEM;
+            items[i] = Simulate(p.Config(), packPath, first, GAMES_PER_ITEM);
+        });
+
+        std::vector<std::pair<uint64_t, Metrics>> fresh;
+        for (size_t k = 0; k < pending.size(); ++k) {
+            Metrics m;
+            for (int j = 0; j < itemsPerPoint; ++j) m.Add(items[k * itemsPerPoint + j]);
+            cache[pending[k].Key()] = m;
+            fresh.push_back({pending[k].Key(), m});
+        }
+        AppendCache(fresh, tag, freshCache);
+        freshCache = false;
+
+        // rank, keep the elite, refill with mutated elite
+        std::vector<std::pair<double, Point>> ranked;
+        for (const auto& p : population) ranked.push_back({Score(cache[p.Key()], targets), p});
+        std::stable_sort(ranked.begin(), ranked.end(),
+                         [](const std::pair<double, Point>& a, const std::pair<double, Point>& b) {
+                             return a.first < b.first;
+                         });
+        if (ranked[0].first < bestScore) { bestScore = ranked[0].first; best = ranked[0].second; }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        DifficultyConfig cfg = best.Config();
+        printf("gen %2d: simulated %zu points (%zu cached) in %.2f s, best %.3f: "
+               "%d pts/level, tick %.3f - %.4f/level, min %.3f, food %d/%d/%d/%d\n",
+               gen + 1, pending.size(), population.size() - pending.size(), seconds, bestScore,
+               cfg.pointsPerLevel, cfg.baseTick, cfg.tickStep, cfg.minTick,
+               cfg.foodValue, cfg.bonusFoodValue, cfg.poisonValue, cfg.levelBonusFood);
+
+        population.clear();
+        for (int i = 0; i < ELITE; ++i) population.push_back(ranked[i].second);
+        while ((int)population.size() < POPULATION) {
+            Point p = population[rng.Below(ELITE)];
+            for (int i = 0; i < GENE_COUNT; ++i) {
+                if (rng.Below(2)) continue;
+                p.g[i] += rng.Below(5) - 2;
+                p.g[i] = std::max(0, std::min(GENES[i].count - 1, p.g[i]));
+            }
+            population.push_back(p);
+        }
+    }
+
+    if (!best.Config().Save(outPath, error)) {
+        fprintf(stderr, "tune: %s\n", error.c_str());
+        return 1;
+    }
+
+    const Metrics& m = cache[best.Key()];
+    printf("wrote %s\nlevel  death%%  target   seconds  target\n", outPath.c_str());
+    for (int l = 0; l < TUNE_LEVELS; ++l) {
+        double rate = m.reached[l] ? 100.0 * m.died[l] / m.reached[l] : 0.0;
+        double secs = m.reached[l] ? m.seconds[l] / m.reached[l] : 0.0;
+        printf("%5d  %6.1f  %6.1f  %8.1f  %6.1f\n", l + 1, rate, 100.0 * targets[l].deathRate,
+               secs, targets[l].seconds);
+    }
+    return 0;
+}